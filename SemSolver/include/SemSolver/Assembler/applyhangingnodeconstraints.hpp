@@ -0,0 +1,109 @@
+#ifndef APPLYHANGINGNODECONSTRAINTS_HPP
+#define APPLYHANGINGNODECONSTRAINTS_HPP
+
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/matrix.hpp>
+#include <SemSolver/vector.hpp>
+
+namespace SemSolver
+{
+    //! \brief Assembler namespace
+    /*! This namespace provides algorithms for the constuction of the algebraic matrices
+        and vectors associated to the discretized problem from geometric and functional
+        information stored in a SemProblem. */
+    namespace Assembler
+    {
+        /*! Condense hanging nodes out of the matrix A of an algebraic system. Writing
+            the values of all nodes as u = T * v, where T keeps free nodes and
+            interpolates hanging ones from their constraints, A is replaced by
+            T' * A * T, whose rows and columns of hanging nodes are then set to the ones
+            of the identity, so that its size and symmetry are kept */
+        //! \param space Space of the system
+        //! \param A Matrix of the system, condensed in place
+        template<class X>
+        void condense_algebraic_matrix(const SemSpace<2, X> &space,
+                                       Matrix<X> &A)
+        {
+            typedef typename SemSpace<2, X>::ConstraintConstIterator ConstraintConstIterator;
+            typedef typename SemSpace<2, X>::Constraint Constraint;
+
+            if(!space.constrainedNodes())
+                return;
+            int n = A.rows();
+            for(ConstraintConstIterator it = space.constraintsBegin();
+            it != space.constraintsEnd(); ++it)
+            {
+                int s = it->first;
+                Constraint const &constraint = it->second;
+                for(unsigned q=0; q<constraint.size(); ++q)
+                    for(int c=0; c<n; ++c)
+                        A[constraint[q].first][c] += constraint[q].second*A[s][c];
+            }
+            for(ConstraintConstIterator it = space.constraintsBegin();
+            it != space.constraintsEnd(); ++it)
+            {
+                int s = it->first;
+                Constraint const &constraint = it->second;
+                for(int r=0; r<n; ++r)
+                    for(unsigned q=0; q<constraint.size(); ++q)
+                        A[r][constraint[q].first] += constraint[q].second*A[r][s];
+            }
+            for(ConstraintConstIterator it = space.constraintsBegin();
+            it != space.constraintsEnd(); ++it)
+            {
+                int s = it->first;
+                for(int c=0; c<n; ++c)
+                {
+                    A[s][c] = 0.;
+                    A[c][s] = 0.;
+                }
+                A[s][s] = 1.;
+            }
+        };
+
+        /*! Condense hanging nodes out of the constant term f of an algebraic system,
+            replacing it with T' * f, see condense_algebraic_matrix */
+        //! \param space Space of the system
+        //! \param f Constant term of the system, condensed in place
+        template<class X>
+        void condense_algebraic_vector(const SemSpace<2, X> &space,
+                                       Vector<X> &f)
+        {
+            typedef typename SemSpace<2, X>::ConstraintConstIterator ConstraintConstIterator;
+            typedef typename SemSpace<2, X>::Constraint Constraint;
+
+            for(ConstraintConstIterator it = space.constraintsBegin();
+            it != space.constraintsEnd(); ++it)
+            {
+                Constraint const &constraint = it->second;
+                for(unsigned q=0; q<constraint.size(); ++q)
+                    f[constraint[q].first] += constraint[q].second*f[it->first];
+                f[it->first] = 0.;
+            }
+        };
+
+        /*! Set the values of hanging nodes in the solution of a condensed system,
+            interpolating them from the free nodes they are constrained to */
+        //! \param space Space of the system
+        //! \param u Solution of the condensed system, completed in place
+        template<class X>
+        void distribute_constrained_values(const SemSpace<2, X> &space,
+                                           Vector<X> &u)
+        {
+            typedef typename SemSpace<2, X>::ConstraintConstIterator ConstraintConstIterator;
+            typedef typename SemSpace<2, X>::Constraint Constraint;
+
+            for(ConstraintConstIterator it = space.constraintsBegin();
+            it != space.constraintsEnd(); ++it)
+            {
+                Constraint const &constraint = it->second;
+                X value = 0.;
+                for(unsigned q=0; q<constraint.size(); ++q)
+                    value += constraint[q].second*u[constraint[q].first];
+                u[it->first] = value;
+            }
+        };
+    };
+};
+
+#endif // APPLYHANGINGNODECONSTRAINTS_HPP
@@ -24,11 +24,11 @@ namespace SemSolver
                                    Vector<X> &vector)
         {
             int n = space.nodes();
-            int N = space.degree();
             int Mb = space.borders();
             vector = Vector<X>(n,0.);
             for(int i=0; i<Mb; ++i)
             {
+                int N = space.borderDegree(i);
                 for(int j=0; j<=N; ++j)
                 {
                     MultiIndex<2> mi;
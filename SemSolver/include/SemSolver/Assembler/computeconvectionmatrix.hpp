@@ -52,8 +52,8 @@ namespace SemSolver
                             Point<2,X> x0 = node0.point();
                             Vector<X> beta = convection->evaluate(x0);
                             Vector<X> const &grad1 =
-                                    space.baseFunction(I1)->\
-                                    evaluateRestrictionGradient(i,x0);
+                                    space.evaluateBaseGradient(I1, i, mi0.subIndex(1),
+                                                               mi0.subIndex(2));
                             matrix[I0][I1] += alpha * scalar(beta,grad1);
                             ++l0;
                             ++l1;
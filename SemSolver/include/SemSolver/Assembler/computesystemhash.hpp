@@ -0,0 +1,148 @@
+#ifndef COMPUTESYSTEMHASH_HPP
+#define COMPUTESYSTEMHASH_HPP
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+
+#include <algorithm>
+#include <vector>
+
+#include <SemSolver/problem.hpp>
+#include <SemSolver/boundaryconditions.hpp>
+#include <SemSolver/diffusionconvectionreactionequation.hpp>
+
+namespace SemSolver
+{
+    //! \brief Assembler namespace
+    /*! This namespace provides algorithms for the constuction of the algebraic matrices
+        and vectors associated to the discretized problem from geometric and functional
+        information stored in a SemProblem. */
+    namespace Assembler
+    {
+        //! Compute a content hash of the inputs the matrix A of a problem depends on
+        /*! Geometry, parameters, diffusion, convection and reaction coefficients,
+            border types and Robin coefficients are hashed; forcing and boundary data
+            are not, since they only enter the constant term. Two problems with the
+            same hash have the same algebraic matrix, so that a stored matrix and its
+            factorizations can be reused. */
+        //! \param problem Problem to be hashed
+        //! \param degrees Degree of each subdomain, see SemSpace::degrees. They are
+        //! hashed only if some differs from the degree parameter
+        //! \param geometry Geometry the space is built on, if it is not the problem one,
+        //! e.g. after subdomains are reordered or refined
+        //! \return SHA-1 digest, empty if the equation type is unknown
+        template<class X>
+        QByteArray compute_system_hash(const Problem<2, X> &problem,
+                                       std::vector<int> const &degrees = std::vector<int>(),
+                                       SemGeometry<2, X> const *geometry = 0)
+        {
+            if( problem.equation()->type()!=Equation<2, X>::DIFFUSION_CONVECTION_REACTION )
+                return QByteArray();
+            const DiffusionConvectionReactionEquation<2, X> *equation =
+                    (const DiffusionConvectionReactionEquation<2, X> *)problem.equation();
+            if(!geometry)
+                geometry = problem.geometry();
+            PSLG<X> const &domain = geometry->domain();
+            Polygonation<2, X> const &sub_domains = geometry->subDomains();
+            BoundaryConditions<2, X> const *conditions = problem.boundaryConditions();
+            SemParameters<X> const *parameters = problem.parameters();
+
+            QByteArray data;
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream.setByteOrder(QDataStream::LittleEndian);
+            stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+            stream << QString("SemSolver system 1");
+
+            stream << (quint32)domain.vertices();
+            for(unsigned i=0; i<domain.vertices(); ++i)
+                stream << (double)domain.vertex(i).x << (double)domain.vertex(i).y;
+            stream << (quint32)domain.segments();
+            for(unsigned i=0; i<domain.segments(); ++i)
+                stream << (qint32)domain.segment(i).number
+                       << (qint32)domain.segment(i).source
+                       << (qint32)domain.segment(i).target;
+            stream << (quint32)sub_domains.size();
+            for(unsigned i=0; i<sub_domains.size(); ++i)
+            {
+                typename Polygonation<2, X>::Element const &element = sub_domains.element(i);
+                stream << (qint32)element.size();
+                for(int j=0; j<element.size(); ++j)
+                    stream << (double)element.vertex(j).x() << (double)element.vertex(j).y()
+                           << (qint32)element.neighbour(j);
+            }
+
+            stream << (qint32)parameters->degree() << (double)parameters->tolerance()
+                   << (double)parameters->penality();
+            if(std::count(degrees.begin(), degrees.end(),
+                          parameters->degree())!=(int)degrees.size())
+            {
+                stream << (quint32)degrees.size();
+                for(unsigned i=0; i<degrees.size(); ++i)
+                    stream << (qint32)degrees[i];
+            }
+
+            stream << (equation->diffusion() ? equation->diffusion()->mml() : QString())
+                   << (equation->convection() ? equation->convection()->mml() : QString())
+                   << (equation->reaction() ? equation->reaction()->mml() : QString());
+
+            for(unsigned i=0; i<domain.segments(); ++i)
+            {
+                int border = domain.segment(i).number;
+                typename BoundaryConditions<2, X>::Type type = conditions->borderType(border);
+                stream << (qint32)type;
+                if(type==BoundaryConditions<2, X>::ROBIN)
+                    stream << conditions->robinCoefficient(border)->mml();
+            }
+
+            return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        };
+
+        //! Compute a content hash of all the inputs of a problem
+        /*! Forcing term and boundary data are hashed together with the hash of the
+            matrix inputs, so that two problems with the same hash have the same
+            solution */
+        //! \param problem Problem to be hashed
+        //! \param degrees Degree of each subdomain, see compute_system_hash
+        //! \param geometry Geometry the space is built on, see compute_system_hash
+        //! \return SHA-1 digest, empty if the equation type is unknown
+        template<class X>
+        QByteArray compute_problem_hash(const Problem<2, X> &problem,
+                                        std::vector<int> const &degrees = std::vector<int>(),
+                                        SemGeometry<2, X> const *geometry = 0)
+        {
+            QByteArray system_hash = compute_system_hash(problem, degrees, geometry);
+            if(system_hash.isEmpty())
+                return QByteArray();
+            const DiffusionConvectionReactionEquation<2, X> *equation =
+                    (const DiffusionConvectionReactionEquation<2, X> *)problem.equation();
+            if(!geometry)
+                geometry = problem.geometry();
+            PSLG<X> const &domain = geometry->domain();
+            BoundaryConditions<2, X> const *conditions = problem.boundaryConditions();
+
+            QByteArray data;
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream.setByteOrder(QDataStream::LittleEndian);
+            stream << QString("SemSolver problem 1") << system_hash;
+            stream << (equation->forcing() ? equation->forcing()->mml() : QString());
+            for(unsigned i=0; i<domain.segments(); ++i)
+            {
+                int border = domain.segment(i).number;
+                typename BoundaryConditions<2, X>::Type type = conditions->borderType(border);
+                if(type==BoundaryConditions<2, X>::DIRICHLET)
+                    stream << conditions->dirichletData(border)->mml();
+                else if(type==BoundaryConditions<2, X>::NEUMANN)
+                    stream << conditions->neumannData(border)->mml();
+                else if(type==BoundaryConditions<2, X>::ROBIN)
+                    stream << conditions->robinData(border)->mml();
+                else
+                    stream << QString();
+            }
+
+            return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        };
+    };
+};
+
+#endif // COMPUTESYSTEMHASH_HPP
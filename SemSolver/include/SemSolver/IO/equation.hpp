@@ -2,8 +2,10 @@
 #define IO_EQUATION_HPP
 
 #include <QFile>
+#include <QIODevice>
 
 #include <SemSolver/equation.hpp>
+#include <SemSolver/IO/nextnonemptlinevalues.hpp>
 
 namespace SemSolver
 {
@@ -12,7 +14,7 @@ namespace SemSolver
     {
         //! Read 2D Equation from file
         template<class X>
-        bool read_equation(QFile *file,
+        bool read_equation(QIODevice *file,
                            Equation<2, X> *&equation);
     };
 };
@@ -21,7 +23,7 @@ namespace SemSolver
 #include <SemSolver/scriptfunction.hpp>
 
 template<class X>
-bool SemSolver::IO::read_equation(QFile *file,
+bool SemSolver::IO::read_equation(QIODevice *file,
                                   Equation<2, X> *&equation)
 {
 #ifdef SEMDEBUG
@@ -1,9 +1,12 @@
 #ifndef IO_GEOMETRY_HPP
 #define IO_GEOMETRY_HPP
 
+#include <QBuffer>
+#include <QByteArray>
 #include <QFile>
 
 #include <SemSolver/semgeometry.hpp>
+#include <SemSolver/polygonationcache.hpp>
 
 #include <SemSolver/IO/archive.hpp>
 #include <SemSolver/IO/pslg.hpp>
@@ -14,60 +17,84 @@ namespace SemSolver
     //! Namespace for Input/Output operations on SemSolver Classes
     namespace IO
     {
-        //! Read SemGeometry form file
+        //! Read SemGeometry from an archive
+        //! Entries are parsed in place, without being extracted
+        /*! If the archive records the hash subdomains were computed with, they are
+            taken from the global PolygonationCache when there, and added to it after
+            being parsed otherwise */
         template<class X>
-        bool read_geometry(QFile *file,
+        bool read_geometry(Archive &archive,
                           SemGeometry<2, X> &geometry)
 {
-    Archive archive(file);
     if(!archive.openRead())
         return false;
-    QTemporaryFile *poly_file, *domains_file;
-    poly_file = new QTemporaryFile();
-    domains_file = new QTemporaryFile();
-    if(!archive.extractFile("pslg.poly", poly_file))
+    QByteArray data;
+    QBuffer buffer;
+    if(!archive.entryData("pslg.poly", data))
     {
-        delete poly_file;
-        delete domains_file;
-        return false;
-    }
-    if(!archive.extractFile("domains.semsub", domains_file))
-    {
-        delete poly_file;
-        delete domains_file;
-        return false;
-    }
-    if(!archive.closeRead())
-    {
-        delete poly_file;
-        delete domains_file;
+        archive.closeRead();
         return false;
     }
+    buffer.setData(data);
     PSLG<double> pslg;
-    if(!SemSolver::IO::read_PSLG(poly_file, pslg))
+    if(!SemSolver::IO::read_PSLG(&buffer, pslg))
     {
-        delete poly_file;
-        delete domains_file;
+        archive.closeRead();
         return false;
     }
+    QByteArray hash;
+    if(archive.contains("domains.hash") && archive.entryData("domains.hash", hash))
+        hash.detach();
     Polygonation<2,double> sub_domains;
-    if(!SemSolver::IO::read_subdomains(domains_file, sub_domains))
+    PolygonationCache<double> &cache = PolygonationCache<double>::global();
+    if(hash.isEmpty() || !cache.find(hash, sub_domains))
     {
-        delete poly_file;
-        delete domains_file;
-        return false;
+        if(!archive.entryData("domains.semsub", data))
+        {
+            archive.closeRead();
+            return false;
+        }
+        buffer.setData(data);
+        if(!SemSolver::IO::read_subdomains(&buffer, sub_domains))
+        {
+            archive.closeRead();
+            return false;
+        }
+        if(!hash.isEmpty())
+            cache.insert(hash, sub_domains);
     }
+    if(!archive.closeRead())
+        return false;
     geometry.setDomain(pslg);
     geometry.setSubDomains(sub_domains);
-    delete poly_file;
-    delete domains_file;
     return true;
 };
 
+        //! Read SemGeometry form file
+        template<class X>
+        bool read_geometry(QFile *file,
+                          SemGeometry<2, X> &geometry)
+{
+    Archive archive(file);
+    return read_geometry(archive, geometry);
+};
+
+        //! Read SemGeometry from memory
+        template<class X>
+        bool read_geometry(QByteArray const &data,
+                          SemGeometry<2, X> &geometry)
+{
+    Archive archive(data);
+    return read_geometry(archive, geometry);
+};
+
         //! Write Geometry archive from pslg and subdomains files
+        //! \param hash Content hash subdomains were computed with, see
+        //! PreProcessor::compute_pslg_hash, empty if not known
         bool write_geometry(QFile *pslg_file,
                            QFile *domains_file,
-                           QFile *file);
+                           QFile *file,
+                           QByteArray const &hash = QByteArray());
     };
 };
 
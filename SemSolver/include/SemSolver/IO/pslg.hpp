@@ -2,9 +2,11 @@
 #define IO_PSLG_HPP
 
 #include <QFile>
+#include <QIODevice>
+#include <QSet>
 
 #include <SemSolver/pslg.hpp>
-#include <SemSolver/IO/nextnonemptlinevalues.hpp>
+#include <SemSolver/IO/texttokenizer.hpp>
 
 namespace SemSolver
 {
@@ -12,7 +14,7 @@ namespace SemSolver
     namespace IO
     {
         template<class X>
-        bool read_PSLG(QFile *file,
+        bool read_PSLG(QIODevice *file,
                       PSLG<X> &pslg)
 {
     pslg.clear();
@@ -28,11 +30,13 @@ namespace SemSolver
         return false;
     }
 #endif
-    QTextStream input(file);
-    QStringList values;
-    values = next_non_empty_line_values(input);
+    TextTokenizer input(file);
 #ifdef SEMDEBUG
-    if(values.isEmpty())
+    QSet<int> vertex_numbers, segment_numbers, hole_numbers;
+#endif
+    input.nextLine();
+#ifdef SEMDEBUG
+    if(input.isEmpty())
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_vertices'");
         file->close();
@@ -40,7 +44,7 @@ namespace SemSolver
     }
 #endif
     bool ok;
-    int number_of_vertices = values[0].toInt(&ok);
+    int number_of_vertices = input.toInt(0, &ok);
 #ifdef SEMDEBUG
     if(!ok)
     {
@@ -59,13 +63,13 @@ namespace SemSolver
 #endif
     pslg.setNumberOfVertices(number_of_vertices);
 #ifdef SEMDEBUG
-    if(values.size()<2)
+    if(input.size()<2)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'dimension'");
         file->close();
         return false;
     }
-    int dimension = values[1].toInt(&ok);
+    int dimension = input.toInt(1, &ok);
     if(!ok)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : 'dimension' must be an integer");
@@ -78,13 +82,13 @@ namespace SemSolver
         file->close();
         return false;
     }
-    if(values.size()<3)
+    if(input.size()<3)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_attributes'");
         file->close();
         return false;
     }
-    int number_of_vertices_attributes = values[2].toInt(&ok);
+    int number_of_vertices_attributes = input.toInt(2, &ok);
     if(!ok)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : 'number_of_vertices_attributes' must"\
@@ -105,14 +109,14 @@ namespace SemSolver
 #endif
     pslg.setNumberOfVerticesAttributes(0);
 #ifdef SEMDEBUG
-    if(values.size()<4)
+    if(input.size()<4)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_vertices_boundary"\
                  "_markers'");
         file->close();
         return false;
     }
-    int number_of_vertices_boundary_markers = values[3].toInt(&ok);
+    int number_of_vertices_boundary_markers = input.toInt(3, &ok);
     if(!ok)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : 'number_of_vertices_boundary_markers"\
@@ -133,7 +137,7 @@ namespace SemSolver
 #endif
     pslg.setNumberOfVerticesBoundaryMarkers(0);
 #ifdef SEMDEBUG
-    if(values.size()>4)
+    if(input.size()>4)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : too many inputs on first line");
         file->close();
@@ -142,16 +146,16 @@ namespace SemSolver
 #endif
     for(int i=0; i<number_of_vertices; ++i)
     {
-        values = next_non_empty_line_values(input);
+        input.nextLine();
 #ifdef SEMDEBUG
-        if(values.isEmpty())
+        if(input.isEmpty())
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Vertex::vertex_number'");
             file->close();
             return false;
         }
 #endif
-        int vertex_number = values[0].toInt(&ok);
+        int vertex_number = input.toInt(0, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -160,24 +164,22 @@ namespace SemSolver
             file->close();
             return false;
         }
-        for(int j=0; j<i; ++j)
+        if(vertex_numbers.contains(vertex_number))
         {
-            if(vertex_number==pslg.vertex(j).number)
-            {
-                qWarning("SemSolver::IO::readPSLG - ERROR : 'Vertex::vertex_number' must"\
-                         "be unique");
-                file->close();
-                return false;
-            }
+            qWarning("SemSolver::IO::readPSLG - ERROR : 'Vertex::vertex_number' must"\
+                     "be unique");
+            file->close();
+            return false;
         }
-        if(values.size()<2)
+        vertex_numbers.insert(vertex_number);
+        if(input.size()<2)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Vertex::x'");
             file->close();
             return false;
         }
 #endif
-        double x = values[1].toDouble(&ok);
+        double x = input.toDouble(1, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -186,14 +188,14 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()<3)
+        if(input.size()<3)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Vertex::y'");
             file->close();
             return false;
         }
 #endif
-        double y = values[2].toDouble(&ok);
+        double y = input.toDouble(2, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -201,13 +203,13 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()<3+number_of_vertices_attributes)
+        if(input.size()<3+number_of_vertices_attributes)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Vertex::attribute'");
             file->close();
             return false;
         }
-        if(values.size()<3+number_of_vertices_attributes
+        if(input.size()<3+number_of_vertices_attributes
            +number_of_vertices_boundary_markers)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Vertex::boundary_marker"\
@@ -218,16 +220,16 @@ namespace SemSolver
 #endif
         pslg.setVertex(i,vertex_number,x,y);
     }
-    values = next_non_empty_line_values(input);
+    input.nextLine();
 #ifdef SEMDEBUG
-    if(values.isEmpty())
+    if(input.isEmpty())
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_segments'");
         file->close();
         return false;
     }
 #endif
-    int number_of_segments = values[0].toInt(&ok);
+    int number_of_segments = input.toInt(0, &ok);
 #ifdef SEMDEBUG
     if(!ok)
     {
@@ -246,14 +248,14 @@ namespace SemSolver
 #endif
     pslg.setNumberOfSegments(number_of_segments);
 #ifdef SEMDEBUG
-    if(values.size()<2)
+    if(input.size()<2)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_segments_boundary"\
                  "_markers'");
         file->close();
         return false;
     }
-    int number_of_segments_boundary_markers = values[1].toInt(&ok);
+    int number_of_segments_boundary_markers = input.toInt(1, &ok);
     if(!ok)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : 'number_of_segments_boundary_markers"\
@@ -271,7 +273,7 @@ namespace SemSolver
     if(number_of_segments_boundary_markers > 0)
         qWarning("SemSolver::IO::readPSLG - ERROR : ignoring segments boundary markers i"\
                  "n 'poly_file'");
-    if(values.size()>2)
+    if(input.size()>2)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : 'too many inputs on segments header "\
                  "line");
@@ -281,9 +283,9 @@ namespace SemSolver
 #endif
     for(int i=0; i<number_of_segments; ++i)
     {
-        values = next_non_empty_line_values(input);
+        input.nextLine();
 #ifdef SEMDEBUG
-        if(values.isEmpty())
+        if(input.isEmpty())
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Segment::segment_number"\
                      "'");
@@ -291,7 +293,7 @@ namespace SemSolver
             return false;
         }
 #endif
-        int segment_number = values[0].toInt(&ok);
+        int segment_number = input.toInt(0, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -300,24 +302,22 @@ namespace SemSolver
             file->close();
             return false;
         }
-        for(int j=0; j<i; ++j)
+        if(segment_numbers.contains(segment_number))
         {
-            if(segment_number==pslg.segment(j).number)
-            {
-                qWarning("SemSolver::IO::readPSLG - ERROR : 'Segment::segment_number' mu"\
-                         "st be unique");
-                file->close();
-                return false;
-            }
+            qWarning("SemSolver::IO::readPSLG - ERROR : 'Segment::segment_number' mu"\
+                     "st be unique");
+            file->close();
+            return false;
         }
-        if(values.size()<2)
+        segment_numbers.insert(segment_number);
+        if(input.size()<2)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Segment::source'");
             file->close();
             return false;
         }
 #endif
-        int source = values[1].toInt(&ok);
+        int source = input.toInt(1, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -326,14 +326,14 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()<3)
+        if(input.size()<3)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Segment::target'");
             file->close();
             return false;
         }
 #endif
-        int target = values[2].toInt(&ok);
+        int target = input.toInt(2, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -342,15 +342,8 @@ namespace SemSolver
             file->close();
             return false;
         }
-        bool found_source = false;
-        bool found_target = false;
-        for(int j=0; j<number_of_vertices && !(found_source&&found_target); ++j)
-        {
-            if(pslg.vertex(j).number==source)
-                found_source = true;
-            if(pslg.vertex(j).number==target)
-                found_target = true;
-        }
+        bool found_source = vertex_numbers.contains(source);
+        bool found_target = vertex_numbers.contains(target);
         if(!found_source)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : 'Segment::source' must be an exi"\
@@ -365,14 +358,14 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()<3+number_of_segments_boundary_markers)
+        if(input.size()<3+number_of_segments_boundary_markers)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR  : missing 'Segment::boundary_mark"\
                      "er'");
             file->close();
             return false;
         }
-        if(values.size()>3+number_of_segments_boundary_markers)
+        if(input.size()>3+number_of_segments_boundary_markers)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : too many inputs on segment line");
             file->close();
@@ -381,16 +374,16 @@ namespace SemSolver
 #endif
         pslg.setSegment(i, segment_number, source, target);
     }
-    values = next_non_empty_line_values(input);
+    input.nextLine();
 #ifdef SEMDEBUG
-    if(values.isEmpty())
+    if(input.isEmpty())
     {
         qWarning("SemSolver::IO::readPSLG - ERROR : missing 'number_of_holes'");
         file->close();
         return false;
     }
 #endif
-    int number_of_holes = values[0].toInt(&ok);
+    int number_of_holes = input.toInt(0, &ok);
 #ifdef SEMDEBUG
     if(!ok)
     {
@@ -406,7 +399,7 @@ namespace SemSolver
         file->close();
         return false;
     }
-    if(values.size()>1)
+    if(input.size()>1)
     {
         qWarning("SemSolver::IO::readPSLG - ERROR  : too many inputs on holes header lin"\
                  "e");
@@ -417,16 +410,16 @@ namespace SemSolver
     pslg.setNumberOfHoles(number_of_holes);
     for(int i=0; i<number_of_holes; ++i)
     {
-        values = next_non_empty_line_values(input);
+        input.nextLine();
 #ifdef SEMDEBUG
-        if(values.isEmpty())
+        if(input.isEmpty())
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Hole::hole_number'");
             file->close();
             return false;
         }
 #endif
-        int hole_number = values[0].toInt(&ok);
+        int hole_number = input.toInt(0, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -435,24 +428,22 @@ namespace SemSolver
             file->close();
             return false;
         }
-        for(int j=0; j<i; ++j)
+        if(hole_numbers.contains(hole_number))
         {
-            if(hole_number==pslg.hole(j).number)
-            {
-                qWarning("SemSolver::IO::readPSLG - ERROR : 'Hole::hole_number' must be "\
-                         "unique");
-                file->close();
-                return false;
-            }
+            qWarning("SemSolver::IO::readPSLG - ERROR : 'Hole::hole_number' must be "\
+                     "unique");
+            file->close();
+            return false;
         }
-        if(values.size()<2)
+        hole_numbers.insert(hole_number);
+        if(input.size()<2)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Hole::x'");
             file->close();
             return false;
         }
 #endif
-        double x = values[1].toDouble(&ok);
+        double x = input.toDouble(1, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -460,14 +451,14 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()<3)
+        if(input.size()<3)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : missing 'Hole::y'");
             file->close();
             return false;
         }
 #endif
-        double y = values[2].toDouble(&ok);
+        double y = input.toDouble(2, &ok);
 #ifdef SEMDEBUG
         if(!ok)
         {
@@ -475,7 +466,7 @@ namespace SemSolver
             file->close();
             return false;
         }
-        if(values.size()>3)
+        if(input.size()>3)
         {
             qWarning("SemSolver::IO::readPSLG - ERROR : 'too many inputs on hole line");
             file->close();
@@ -484,9 +475,9 @@ namespace SemSolver
 #endif
         pslg.setHole(i, hole_number, x, y);
     }
-    values = next_non_empty_line_values(input);
+    input.nextLine();
 #ifdef SEMDEBUG
-    if(!values.isEmpty())
+    if(!input.isEmpty())
         qWarning("SemSolver::IO::readPSLG - ERROR : ignoring extra information in 'poly_"\
                  "file'");
 #endif
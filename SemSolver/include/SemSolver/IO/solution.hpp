@@ -0,0 +1,208 @@
+#ifndef IO_SOLUTION_HPP
+#define IO_SOLUTION_HPP
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QIODevice>
+
+#include <algorithm>
+#include <vector>
+
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/vector.hpp>
+
+namespace SemSolver
+{
+    //! Namespace for Input/Output operations on SemSolver Classes
+    namespace IO
+    {
+        //! Binary solution file layout
+        /*! All values are little-endian. The file starts with a 64 bytes header:
+            - 8 bytes magic "SEMSLN\0\0"
+            - quint32 version, quint32 header size
+            - quint32 maximum degree N of subdomains, quint32 reserved
+            - quint64 number of nodes n, quint64 number of elements M
+            - quint64 offsets of coordinates, coefficients and connectivity blocks
+
+            Blocks start at multiples of 64 bytes. Coordinates are n doubles x followed
+            by n doubles y, coefficients are n doubles u and connectivity holds the M
+            qint32 degrees N_e of the elements followed by the (N_e+1)^2 qint32 node
+            indices of each element, (j, k)-th node at k*(N_e+1)+j. Version 1 files have
+            no degrees and all elements have degree N */
+        namespace SolutionFormat
+        {
+            static const char magic[8] = {'S','E','M','S','L','N','\0','\0'};
+            static const quint32 version = 2;
+            static const quint32 header_size = 64;
+            static const quint64 alignment = 64;
+
+            //! Get first aligned offset not before offset
+            inline quint64 align(quint64 const &offset)
+            {
+                return (offset+alignment-1)/alignment*alignment;
+            };
+        };
+
+        //! Write a solution to a binary file
+        //! \param space Space of the solution
+        //! \param coefficients Fourier coefficients of the solution
+        //! \param file File or buffer where to write the solution
+        template<class X>
+        bool write_solution(SemSpace<2, X> const &space,
+                            Vector<X> const &coefficients,
+                            QIODevice *file);
+
+        //! Class for reading binary solution files
+        /*! The file is memory mapped, so that opening it only scans the degrees of
+            the elements and arrays are accessed in place. On big-endian hosts or if mapping fails the
+            file is read into memory instead. Solutions can also be read from a memory
+            buffer, e.g. an entry of a workspace. */
+        class SolutionFile
+        {
+            QFile         *file;
+            uchar         *mapped;
+            QByteArray    memory;
+            char const    *base;
+            quint32       _version;
+            quint32       _degree;
+            quint64       _nodes;
+            quint64       _elements;
+            quint64       coordinates_offset;
+            quint64       coefficients_offset;
+            quint64       connectivity_offset;
+            quint64       indices_offset;
+            std::vector<quint64> element_offsets;
+
+        public:
+            //! Default constructor
+            //! file pointer to solution file
+            SolutionFile(QFile *file);
+
+            //! Constructor of a solution in memory
+            //! data content of the solution file
+            SolutionFile(QByteArray const &data);
+
+            //! Destructor, closes the file
+            ~SolutionFile();
+
+            //! Open solution file and check its header
+            bool open();
+
+            //! Close solution file
+            void close();
+
+            //! Get format version
+            inline quint32 version() const
+            {
+                return _version;
+            };
+
+            //! Get maximum polynomial degree of elements
+            inline int degree() const
+            {
+                return _degree;
+            };
+
+            //! Get polynomial degree of an element
+            inline int degree(qint64 const &element) const
+            {
+                if(_version<2)
+                    return _degree;
+                return ((qint32 const *)(base+connectivity_offset))[element];
+            };
+
+            //! Get number of nodes
+            inline qint64 nodes() const
+            {
+                return _nodes;
+            };
+
+            //! Get number of elements
+            inline qint64 elements() const
+            {
+                return _elements;
+            };
+
+            //! Get nodes x coordinates
+            inline double const *x() const
+            {
+                return (double const *)(base+coordinates_offset);
+            };
+
+            //! Get nodes y coordinates
+            inline double const *y() const
+            {
+                return (double const *)(base+coordinates_offset) + _nodes;
+            };
+
+            //! Get Fourier coefficients
+            inline double const *u() const
+            {
+                return (double const *)(base+coefficients_offset);
+            };
+
+            //! Get node indices of an element
+            //! (j, k)-th node of element e of degree N is at k*(N+1)+j
+            inline qint32 const *connectivity(qint64 const &element) const
+            {
+                return (qint32 const *)(base+indices_offset) + element_offsets[element];
+            };
+        };
+    };
+};
+
+template<class X>
+bool SemSolver::IO::write_solution(SemSpace<2, X> const &space,
+                                   Vector<X> const &coefficients,
+                                   QIODevice *file)
+{
+    using namespace SolutionFormat;
+    quint64 n = space.nodes();
+    quint64 M = space.subDomains();
+    int N = 0;
+    for(quint64 e=0; e<M; ++e)
+        N = std::max(N, space.degree(e));
+#ifdef SEMDEBUG
+    if((quint64)coefficients.rows()!=n)
+    {
+        qWarning("SemSolver::IO::write_solution - ERROR : coefficients do not match spac"\
+                 "e nodes.");
+        return false;
+    }
+#endif
+    quint64 coordinates = align(header_size);
+    quint64 values = align(coordinates + 2*n*sizeof(double));
+    quint64 connectivity = align(values + n*sizeof(double));
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QDataStream output(file);
+    output.setByteOrder(QDataStream::LittleEndian);
+    output.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    static const char padding[64] = {0};
+
+    output.writeRawData(magic, 8);
+    output << version << header_size << (quint32)N << (quint32)0;
+    output << n << M << coordinates << values << connectivity;
+
+    output.writeRawData(padding, coordinates-header_size);
+    for(quint64 i=0; i<n; ++i)
+        output << (double)space.node(i).point().x();
+    for(quint64 i=0; i<n; ++i)
+        output << (double)space.node(i).point().y();
+    output.writeRawData(padding, values-coordinates-2*n*sizeof(double));
+    for(quint64 i=0; i<n; ++i)
+        output << (double)coefficients[i];
+    output.writeRawData(padding, connectivity-values-n*sizeof(double));
+    for(quint64 e=0; e<M; ++e)
+        output << (qint32)space.degree(e);
+    for(quint64 e=0; e<M; ++e)
+        for(int k=0; k<=space.degree(e); ++k)
+            for(int j=0; j<=space.degree(e); ++j)
+                output << (qint32)space.subDomainIndex(e, j, k);
+    bool ok = output.status()==QDataStream::Ok;
+    file->close();
+    return ok;
+};
+
+#endif // IO_SOLUTION_HPP
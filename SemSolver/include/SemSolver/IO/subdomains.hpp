@@ -2,12 +2,14 @@
 #define IO_SUBDOMAINS_HPP
 
 #include <QFile>
+#include <QIODevice>
 #include <QTextStream>
 #ifdef SEMDEBUG
 #  include <QDebug>
 #endif
 
 #include  <SemSolver/polygonation.hpp>
+#include  <SemSolver/IO/texttokenizer.hpp>
 
 namespace SemSolver
 {
@@ -16,23 +18,23 @@ namespace SemSolver
     {
         //! Read subdomains Polygonation from file
         template<class X>
-        bool read_subdomains(QFile *file,
+        bool read_subdomains(QIODevice *file,
                             Polygonation<2, X> &sub_domains)
 {
     if(!file->open(QIODevice::ReadOnly))
         return false;
-    QTextStream input(file);
+    TextTokenizer input(file);
     sub_domains.clear();
-    int size, polygon_size, id, neighbour;
-    double x, y;
+    int size = 0, polygon_size = 0, id = 0, neighbour = 0;
+    double x = 0., y = 0.;
     Polygon<2,X> polygon;
     std::vector<int> neighbours;
-    input >> size;
+    input.next(size);
     for(int i=0; i<size; ++i)
     {
         polygon.clear();
         neighbours.clear();
-        input >> id;
+        input.next(id);
 #ifdef SEMDEBUG
         if(id!=i+1)
         {
@@ -40,12 +42,12 @@ namespace SemSolver
             return false;
         }
 #endif
-        input >> polygon_size;
+        input.next(polygon_size);
         for(int j=0; j<polygon_size; ++j)
         {
-            input >> x;
-            input >> y;
-            input >> neighbour;
+            input.next(x);
+            input.next(y);
+            input.next(neighbour);
             polygon.push_back(Point<2,X>(x,y));
             neighbours.push_back(neighbour);
         }
@@ -58,7 +60,7 @@ namespace SemSolver
         //! Write subdomains Polygonation to file
         template<class X>
         bool write_subdomains(Polygonation<2, X> const &sub_domains,
-                             QFile *file)
+                             QIODevice *file)
 {
     if(!file->open(QIODevice::WriteOnly))
         return false;
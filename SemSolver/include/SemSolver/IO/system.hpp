@@ -0,0 +1,218 @@
+#ifndef IO_SYSTEM_HPP
+#define IO_SYSTEM_HPP
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+
+#include <vector>
+
+#include <SemSolver/matrix.hpp>
+#include <SemSolver/Solver/factorization.hpp>
+
+namespace SemSolver
+{
+    //! Namespace for Input/Output operations on SemSolver Classes
+    namespace IO
+    {
+        //! Binary assembled system file layout
+        /*! All values are little-endian. The file starts with a 128 bytes header:
+            - 8 bytes magic "SEMSYS\0\0"
+            - quint32 version, quint32 header size
+            - quint32 factorization type, quint32 reserved
+            - quint64 size n of the matrix
+            - quint64 offsets of matrix, first factor, second factor and pivot blocks,
+              0 for missing blocks
+            - 20 bytes SHA-1 hash of the problem inputs, see
+              Assembler::compute_system_hash
+
+            Blocks start at multiples of 64 bytes. Matrix and factors are n*n doubles
+            by rows, pivot is n qint32. */
+        namespace SystemFormat
+        {
+            static const char magic[8] = {'S','E','M','S','Y','S','\0','\0'};
+            static const quint32 version = 1;
+            static const quint32 header_size = 128;
+            static const quint64 alignment = 64;
+            static const int hash_size = 20;
+
+            //! Get first aligned offset not before offset
+            inline quint64 align(quint64 const &offset)
+            {
+                return (offset+alignment-1)/alignment*alignment;
+            };
+
+            //! Write rows of an array as doubles
+            template<class X>
+            void write_rows(QDataStream &output, TNT::Array2D<X> const &array)
+            {
+                std::vector<double> row(array.dim2());
+                for(int i=0; i<array.dim1(); ++i)
+                {
+                    for(int j=0; j<array.dim2(); ++j)
+                        row[j] = array[i][j];
+                    if(Q_BYTE_ORDER==Q_LITTLE_ENDIAN)
+                        output.writeRawData((char const *)&row[0], row.size()*sizeof(double));
+                    else
+                        for(unsigned j=0; j<row.size(); ++j)
+                            output << row[j];
+                }
+            };
+        };
+
+        //! Write an assembled matrix and its factorization to a binary file
+        //! \param file File where to write the system
+        //! \param hash Hash of the problem inputs the matrix was assembled from
+        //! \param A The assembled matrix
+        //! \param factorization A factorization of A, may be empty
+        template<class X>
+        bool write_system(QFile *file,
+                          QByteArray const &hash,
+                          Matrix<X> const &A,
+                          Solver::Factorization<X> const &factorization);
+
+        //! Get the file where the system of a workspace with a given hash is stored
+        /*! Systems are kept beside the workspace, in a directory named after it, one
+            file per hash */
+        //! \param workspace Path of the workspace file
+        //! \param hash Hash of the problem inputs
+        QString get_system_file_name(QString const &workspace, QByteArray const &hash);
+
+        //! Class for reading binary assembled system files
+        /*! The file is memory mapped, so that opening it takes constant time and the
+            matrix and factors are used in place. On big-endian hosts or if mapping
+            fails the file is read into memory instead. */
+        class SystemFile
+        {
+            QFile         *file;
+            uchar         *mapped;
+            QByteArray    memory;
+            char const    *base;
+            quint32       _version;
+            quint32       _type;
+            quint64       _size;
+            quint64       matrix_offset;
+            quint64       first_offset;
+            quint64       second_offset;
+            quint64       pivot_offset;
+            QByteArray    _hash;
+
+        public:
+            //! Default constructor
+            //! file pointer to system file
+            SystemFile(QFile *file);
+
+            //! Destructor, closes the file
+            ~SystemFile();
+
+            //! Open system file and check its header
+            bool open();
+
+            //! Close system file
+            /*! Matrix, factors and factorizations got from the file are invalid
+                afterwards */
+            void close();
+
+            //! Get format version
+            inline quint32 version() const
+            {
+                return _version;
+            };
+
+            //! Get size of the matrix
+            inline int size() const
+            {
+                return _size;
+            };
+
+            //! Get hash of the problem inputs
+            inline QByteArray const &hash() const
+            {
+                return _hash;
+            };
+
+            //! Get the matrix values by rows
+            inline double const *matrix() const
+            {
+                return (double const *)(base+matrix_offset);
+            };
+
+            //! Get the factorization type
+            inline Solver::Factorization<double>::Type type() const
+            {
+                return (Solver::Factorization<double>::Type)_type;
+            };
+
+            //! Get the factorization stored in the file
+            /*! Factors are used in place, file must stay open while it is used */
+            Solver::Factorization<double> factorization() const;
+        };
+    };
+};
+
+template<class X>
+bool SemSolver::IO::write_system(QFile *file,
+                                 QByteArray const &hash,
+                                 Matrix<X> const &A,
+                                 Solver::Factorization<X> const &factorization)
+{
+    using namespace SystemFormat;
+    quint64 n = A.rows();
+    typedef Solver::Factorization<X> Factorization;
+#ifdef SEMDEBUG
+    if(hash.size()!=hash_size || (quint64)A.columns()!=n
+       || (factorization.type()!=Factorization::NONE
+           && (quint64)factorization.size()!=n))
+    {
+        qWarning("SemSolver::IO::write_system - ERROR : hash, matrix and factorization do"\
+                 " not match.");
+        return false;
+    }
+#endif
+    bool second = factorization.type()==Factorization::QR;
+    bool pivot = factorization.type()==Factorization::LU;
+    quint64 block = n*n*sizeof(double);
+    quint64 matrix_offset = align(header_size);
+    quint64 first_offset = factorization.type()==Factorization::NONE ? 0
+                           : align(matrix_offset + block);
+    quint64 second_offset = second ? align(first_offset + block) : 0;
+    quint64 pivot_offset = pivot ? align(first_offset + block) : 0;
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QDataStream output(file);
+    output.setByteOrder(QDataStream::LittleEndian);
+    output.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    static const char padding[128] = {0};
+
+    output.writeRawData(magic, 8);
+    output << version << header_size << (quint32)factorization.type() << (quint32)0;
+    output << n << matrix_offset << first_offset << second_offset << pivot_offset;
+    output.writeRawData(hash.constData(), hash_size);
+    output.writeRawData(padding, header_size-64-hash_size);
+
+    write_rows(output, A);
+    quint64 end = matrix_offset + block;
+    if(first_offset)
+    {
+        output.writeRawData(padding, first_offset-end);
+        write_rows(output, factorization.first());
+        end = first_offset + block;
+    }
+    if(second_offset)
+    {
+        output.writeRawData(padding, second_offset-end);
+        write_rows(output, factorization.second());
+    }
+    if(pivot_offset)
+    {
+        output.writeRawData(padding, pivot_offset-end);
+        for(quint64 i=0; i<n; ++i)
+            output << (qint32)factorization.pivot()[i];
+    }
+    bool ok = output.status()==QDataStream::Ok;
+    file->close();
+    return ok;
+};
+
+#endif // IO_SYSTEM_HPP
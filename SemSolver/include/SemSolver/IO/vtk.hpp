@@ -0,0 +1,270 @@
+#ifndef IO_VTK_HPP
+#define IO_VTK_HPP
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+
+#include <vector>
+
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/vector.hpp>
+#include <SemSolver/PostProcessor/computeplotcells.hpp>
+
+namespace SemSolver
+{
+    //! Namespace for Input/Output operations on SemSolver Classes
+    namespace IO
+    {
+        //! Write a solution as a VTK XML unstructured grid
+        /*! Arrays are stored in raw binary appended format and streamed straight from
+            the space and the coefficients, so that no copy of the solution is built.
+            Cells are either the N^2 linear quadrilaterals of each subdomain of degree N
+            used for plotting, or one Lagrange quadrilateral of degree N per
+            subdomain. */
+        //! \param space Space of the solution
+        //! \param u Fourier coefficients of the solution
+        //! \param file File where to write the solution
+        //! \param lagrange Whether to write Lagrange cells
+        template<class X>
+        bool write_vtu(SemSpace<2, X> const &space,
+                       Vector<X> const &u,
+                       QFile *file,
+                       bool const &lagrange = false);
+
+        //! Write a solution as a legacy binary VTK unstructured grid
+        //! Same as write_vtu but in the legacy format, which is big-endian
+        template<class X>
+        bool write_vtk(SemSpace<2, X> const &space,
+                       Vector<X> const &u,
+                       QFile *file,
+                       bool const &lagrange = false);
+
+        //! Compute node indices of a subdomain as a VTK Lagrange quadrilateral
+        /*! VTK orders corners first, then edge nodes along bottom, right, top and left
+            edge each in increasing parameter, then interior nodes row by row */
+        template<class X>
+        void compute_vtk_lagrange_cell(SemSpace<2, X> const &space,
+                                       int const &element,
+                                       std::vector<int> &cell);
+    };
+};
+
+template<class X>
+void SemSolver::IO::compute_vtk_lagrange_cell(SemSpace<2, X> const &space,
+                                              int const &element,
+                                              std::vector<int> &cell)
+{
+    int N = space.degree(element);
+    cell.resize((N+1)*(N+1));
+    for(int k=0; k<=N; ++k)
+    {
+        for(int j=0; j<=N; ++j)
+        {
+            bool j_border = (j==0 || j==N);
+            bool k_border = (k==0 || k==N);
+            int index;
+            if(j_border && k_border)
+                index = j ? (k ? 2 : 1) : (k ? 3 : 0);
+            else if(k_border)
+                index = 4 + (j-1) + (k ? 2*(N-1) : 0);
+            else if(j_border)
+                index = 4 + (k-1) + (j ? N-1 : 3*(N-1));
+            else
+                index = 4 + 4*(N-1) + (j-1) + (N-1)*(k-1);
+            cell[index] = space.subDomainIndex(element, j, k);
+        }
+    }
+};
+
+template<class X>
+bool SemSolver::IO::write_vtu(SemSpace<2, X> const &space,
+                              Vector<X> const &u,
+                              QFile *file,
+                              bool const &lagrange)
+{
+    quint64 n = space.nodes();
+    int M = space.subDomains();
+    quint64 cells = lagrange ? M : PostProcessor::compute_plot_cells_number(space);
+    quint64 connectivity_size = 4*cells;
+    if(lagrange)
+    {
+        connectivity_size = 0;
+        for(int i=0; i<M; ++i)
+            connectivity_size += (space.degree(i)+1)*(space.degree(i)+1);
+    }
+    quint8 cell_type = lagrange ? 70 : 9;   // VTK_LAGRANGE_QUADRILATERAL, VTK_QUAD
+
+    // each appended array is preceded by its size in bytes
+    quint64 u_offset = 0;
+    quint64 points_offset = u_offset + 8 + n*8;
+    quint64 connectivity_offset = points_offset + 8 + 3*n*8;
+    quint64 offsets_offset = connectivity_offset + 8 + connectivity_size*8;
+    quint64 types_offset = offsets_offset + 8 + cells*8;
+
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QByteArray header;
+    header += "<?xml version=\"1.0\"?>\n";
+    header += "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+              "byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+    header += "  <UnstructuredGrid>\n";
+    header += "    <Piece NumberOfPoints=\"" + QByteArray::number(n)
+              + "\" NumberOfCells=\"" + QByteArray::number(cells) + "\">\n";
+    header += "      <PointData Scalars=\"u\">\n";
+    header += "        <DataArray type=\"Float64\" Name=\"u\" format=\"appended\" "
+              "offset=\"" + QByteArray::number(u_offset) + "\"/>\n";
+    header += "      </PointData>\n";
+    header += "      <Points>\n";
+    header += "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" "
+              "format=\"appended\" offset=\"" + QByteArray::number(points_offset)
+              + "\"/>\n";
+    header += "      </Points>\n";
+    header += "      <Cells>\n";
+    header += "        <DataArray type=\"Int64\" Name=\"connectivity\" "
+              "format=\"appended\" offset=\"" + QByteArray::number(connectivity_offset)
+              + "\"/>\n";
+    header += "        <DataArray type=\"Int64\" Name=\"offsets\" format=\"appended\" "
+              "offset=\"" + QByteArray::number(offsets_offset) + "\"/>\n";
+    header += "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" "
+              "offset=\"" + QByteArray::number(types_offset) + "\"/>\n";
+    header += "      </Cells>\n";
+    header += "    </Piece>\n";
+    header += "  </UnstructuredGrid>\n";
+    header += "  <AppendedData encoding=\"raw\">\n   _";
+    file->write(header);
+
+    QDataStream output(file);
+    output.setByteOrder(QDataStream::LittleEndian);
+    output.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    output << (quint64)(n*8);
+    for(quint64 i=0; i<n; ++i)
+        output << (double)u[i];
+
+    output << (quint64)(3*n*8);
+    for(quint64 i=0; i<n; ++i)
+        output << (double)space.node(i).point().x() << (double)space.node(i).point().y()
+               << 0.;
+
+    output << (quint64)(connectivity_size*8);
+    if(lagrange)
+    {
+        std::vector<int> cell;
+        for(int i=0; i<M; ++i)
+        {
+            compute_vtk_lagrange_cell(space, i, cell);
+            for(unsigned l=0; l<cell.size(); ++l)
+                output << (qint64)cell[l];
+        }
+    }
+    else
+    {
+        int cell[4];
+        for(int i=0; i<M; ++i)
+            for(int j=0; j<space.degree(i); ++j)
+                for(int k=0; k<space.degree(i); ++k)
+                {
+                    PostProcessor::compute_plot_cell(space, i, j, k, cell);
+                    output << (qint64)cell[0] << (qint64)cell[1] << (qint64)cell[2]
+                           << (qint64)cell[3];
+                }
+    }
+
+    output << (quint64)(cells*8);
+    if(lagrange)
+    {
+        quint64 offset = 0;
+        for(int i=0; i<M; ++i)
+        {
+            offset += (space.degree(i)+1)*(space.degree(i)+1);
+            output << (qint64)offset;
+        }
+    }
+    else
+        for(quint64 i=1; i<=cells; ++i)
+            output << (qint64)(4*i);
+
+    output << (quint64)cells;
+    for(quint64 i=0; i<cells; ++i)
+        output << cell_type;
+
+    bool ok = output.status()==QDataStream::Ok;
+    ok = ok && file->write("\n  </AppendedData>\n</VTKFile>\n")>0;
+    file->close();
+    return ok;
+};
+
+template<class X>
+bool SemSolver::IO::write_vtk(SemSpace<2, X> const &space,
+                              Vector<X> const &u,
+                              QFile *file,
+                              bool const &lagrange)
+{
+    quint64 n = space.nodes();
+    int M = space.subDomains();
+    quint64 cells = lagrange ? M : PostProcessor::compute_plot_cells_number(space);
+    quint64 connectivity_size = 4*cells;
+    if(lagrange)
+    {
+        connectivity_size = 0;
+        for(int i=0; i<M; ++i)
+            connectivity_size += (space.degree(i)+1)*(space.degree(i)+1);
+    }
+    qint32 cell_type = lagrange ? 70 : 9;   // VTK_LAGRANGE_QUADRILATERAL, VTK_QUAD
+
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QDataStream output(file);
+    output.setByteOrder(QDataStream::BigEndian);
+    output.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    file->write("# vtk DataFile Version 3.0\nSemSolver solution\nBINARY\n"
+                "DATASET UNSTRUCTURED_GRID\nPOINTS " + QByteArray::number(n)
+                + " double\n");
+    for(quint64 i=0; i<n; ++i)
+        output << (double)space.node(i).point().x() << (double)space.node(i).point().y()
+               << 0.;
+
+    file->write("\nCELLS " + QByteArray::number(cells) + " "
+                + QByteArray::number(cells+connectivity_size) + "\n");
+    if(lagrange)
+    {
+        std::vector<int> cell;
+        for(int i=0; i<M; ++i)
+        {
+            compute_vtk_lagrange_cell(space, i, cell);
+            output << (qint32)cell.size();
+            for(unsigned l=0; l<cell.size(); ++l)
+                output << (qint32)cell[l];
+        }
+    }
+    else
+    {
+        int cell[4];
+        for(int i=0; i<M; ++i)
+            for(int j=0; j<space.degree(i); ++j)
+                for(int k=0; k<space.degree(i); ++k)
+                {
+                    PostProcessor::compute_plot_cell(space, i, j, k, cell);
+                    output << (qint32)4 << (qint32)cell[0] << (qint32)cell[1]
+                           << (qint32)cell[2] << (qint32)cell[3];
+                }
+    }
+
+    file->write("\nCELL_TYPES " + QByteArray::number(cells) + "\n");
+    for(quint64 i=0; i<cells; ++i)
+        output << cell_type;
+
+    file->write("\nPOINT_DATA " + QByteArray::number(n)
+                + "\nSCALARS u double 1\nLOOKUP_TABLE default\n");
+    for(quint64 i=0; i<n; ++i)
+        output << (double)u[i];
+
+    bool ok = output.status()==QDataStream::Ok;
+    ok = ok && file->write("\n")>0;
+    file->close();
+    return ok;
+};
+
+#endif // IO_VTK_HPP
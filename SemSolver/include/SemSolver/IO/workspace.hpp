@@ -1,6 +1,8 @@
 #ifndef WORKSPACE_HPP
 #define WORKSPACE_HPP
 
+#include <QBuffer>
+#include <QByteArray>
 #include <QFile>
 #include <QString>
 #include <QStringList>
@@ -9,11 +11,15 @@
 #include <SemSolver/equation.hpp>
 #include <SemSolver/boundaryconditions.hpp>
 #include <SemSolver/semparameters.hpp>
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/vector.hpp>
 
+#include  <SemSolver/IO/archive.hpp>
 #include  <SemSolver/IO/geometry.hpp>
 #include  <SemSolver/IO/equation.hpp>
 #include  <SemSolver/IO/boundaryconditions.hpp>
 #include  <SemSolver/IO/parameters.hpp>
+#include  <SemSolver/IO/solution.hpp>
 
 namespace SemSolver
 {
@@ -57,12 +63,88 @@ namespace SemSolver
                                       QString const &name,
                                       QFile *file);
         //! Add an entry to workspace
+        /*! The entry is appended to the workspace, overriding any entry with the same
+            name. The workspace is compacted when more than half of it is taken by
+            overridden or removed entries. Entries are stored block compressed when a
+            compression level is set, see set_workspace_compression_level, and this
+            makes them smaller */
         bool add_file_to_workspace(QFile *workspace,
                                 QString const &name,
                                 QFile *file);
         //! Remove an entry from workspace
+        /*! A tombstone is appended to the workspace, which is compacted when more than
+            half of it is taken by overridden or removed entries */
         bool remove_file_from_workspace(QFile *workspace,
                                    QString const &name);
+        //! Set zlib level of entries added to workspaces from now on
+        /*! At level 0, the default, entries are stored as plain files, so that
+            workspaces can be extracted with tar and read by older versions. At levels
+            from 1 to 9 entries are stored block compressed, see Archive, and only
+            versions which support it can read them */
+        void set_workspace_compression_level(int const &level);
+        //! Get zlib level of entries added to workspaces
+        int workspace_compression_level();
+        //! Rewrite workspace dropping overridden and removed entries
+        //! \param removed Name of an entry to drop as well
+        bool compact_workspace(QFile *workspace,
+                               QString const &removed = QString());
+        //! Default size limit of solutions cached in a workspace
+        static const qint64 solution_cache_capacity = 64 << 20;
+        //! Get a solution cached in workspace
+        /*! Solutions are cached under "solutions/<hash>.semsln" in the binary solution
+            format, and the list "solutions.semcache" records their sizes and order of
+            use. A hit marks the solution as the most recently used one */
+        //! \param hash Content hash of the problem, see Assembler::compute_problem_hash
+        //! \param data Reference to the array where to store the solution file
+        bool get_cached_solution_from_workspace(QFile *workspace,
+                                                QByteArray const &hash,
+                                                QByteArray &data);
+        //! Add a solution to the cache of a workspace
+        /*! Least recently used solutions are evicted to keep the cache within
+            capacity, solutions larger than capacity are not cached */
+        //! \param hash Content hash of the problem, see Assembler::compute_problem_hash
+        //! \param data Solution file
+        //! \param capacity Size limit of cached solutions
+        bool add_cached_solution_to_workspace(QFile *workspace,
+                                              QByteArray const &hash,
+                                              QByteArray const &data,
+                                              qint64 const &capacity =
+                                                  solution_cache_capacity);
+        //! Default size limit of subdomains cached in a workspace
+        static const qint64 subdomains_cache_capacity = 64 << 20;
+        //! Get subdomains cached in workspace
+        /*! Subdomains computed from a PSLG are cached under "subdomains/<hash>.semsub"
+            in the subdomains format, and the list "subdomains.semcache" records their
+            sizes and order of use, as for solutions */
+        //! \param hash Content hash of the PSLG and mesher options, see
+        //! PreProcessor::compute_pslg_hash
+        //! \param data Reference to the array where to store the subdomains file
+        bool get_cached_subdomains_from_workspace(QFile *workspace,
+                                                  QByteArray const &hash,
+                                                  QByteArray &data);
+        //! Add subdomains to the cache of a workspace
+        //! \param hash Content hash of the PSLG and mesher options
+        //! \param data Subdomains file
+        //! \param capacity Size limit of cached subdomains
+        bool add_cached_subdomains_to_workspace(QFile *workspace,
+                                                QByteArray const &hash,
+                                                QByteArray const &data,
+                                                qint64 const &capacity =
+                                                    subdomains_cache_capacity);
+        //! Get coefficients of a solution cached in workspace
+        template<class X>
+        bool get_cached_solution_from_workspace(QFile *workspace,
+                                                QByteArray const &hash,
+                                                SemSpace<2, X> const &space,
+                                                Vector<X> &coefficients);
+        //! Add a solution to the cache of a workspace
+        template<class X>
+        bool add_cached_solution_to_workspace(QFile *workspace,
+                                              QByteArray const &hash,
+                                              SemSpace<2, X> const &space,
+                                              Vector<X> const &coefficients,
+                                              qint64 const &capacity =
+                                                  solution_cache_capacity);
     };
 };
 
@@ -71,19 +153,19 @@ bool SemSolver::IO::get_geometry_from_workspace(QFile *file,
                                              const QString &name,
                                              SemGeometry<2,X> &geometry)
 {
-    QTemporaryFile *temp_file = new QTemporaryFile();
-    if(!extract_file_from_workspace(file, name + ".semgeo", temp_file))
-    {
-        delete temp_file;
+    Archive archive(file);
+    if(!archive.openRead())
         return false;
-    }
-    if(!read_geometry(temp_file, geometry))
+    QByteArray data;
+    if(!archive.entryData(name + ".semgeo", data))
     {
-        delete temp_file;
+        archive.closeRead();
         return false;
     }
-    delete temp_file;
-    return true;
+    bool ok = read_geometry(data, geometry);
+    if(!archive.closeRead())
+        return false;
+    return ok;
 };
 
 template<class X>
@@ -91,19 +173,21 @@ bool SemSolver::IO::get_equation_from_workspace(QFile *file,
                                              const QString &name,
                                              Equation<2, X> *&equation)
 {
-    QTemporaryFile *temp_file = new QTemporaryFile();
-    if(!extract_file_from_workspace(file, name + ".semeqn", temp_file))
-    {
-        delete temp_file;
+    Archive archive(file);
+    if(!archive.openRead())
         return false;
-    }
-    if(!read_equation(temp_file, equation))
+    QByteArray data;
+    if(!archive.entryData(name + ".semeqn", data))
     {
-        delete temp_file;
+        archive.closeRead();
         return false;
     }
-    delete temp_file;
-    return true;
+    QBuffer buffer;
+    buffer.setData(data);
+    bool ok = read_equation(&buffer, equation);
+    if(!archive.closeRead())
+        return false;
+    return ok;
 };
 
 template<class X>
@@ -111,19 +195,21 @@ bool SemSolver::IO::get_boundary_conditions_from_workspace(QFile *file,
                                                        const QString &name,
                                                        BoundaryConditions<2, X> &bc)
 {
-    QTemporaryFile *temp_file = new QTemporaryFile();
-    if(!extract_file_from_workspace(file, name + ".sembcs", temp_file))
-    {
-        delete temp_file;
+    Archive archive(file);
+    if(!archive.openRead())
         return false;
-    }
-    if(!read_boundary_conditions(temp_file, bc))
+    QByteArray data;
+    if(!archive.entryData(name + ".sembcs", data))
     {
-        delete temp_file;
+        archive.closeRead();
         return false;
     }
-    delete temp_file;
-    return true;
+    QBuffer buffer;
+    buffer.setData(data);
+    bool ok = read_boundary_conditions(&buffer, bc);
+    if(!archive.closeRead())
+        return false;
+    return ok;
 };
 
 template<class X>
@@ -131,19 +217,58 @@ bool SemSolver::IO::get_parameters_from_workspace(QFile *file,
                                                const QString &name,
                                                SemParameters<X> &parameters)
 {
-    QTemporaryFile *temp_file = new QTemporaryFile();
-    if(!extract_file_from_workspace(file, name + ".semprm", temp_file))
-    {
-        delete temp_file;
+    Archive archive(file);
+    if(!archive.openRead())
         return false;
-    }
-    if(!read_parameters(temp_file, parameters))
+    QByteArray data;
+    if(!archive.entryData(name + ".semprm", data))
     {
-        delete temp_file;
+        archive.closeRead();
         return false;
     }
-    delete temp_file;
+    QBuffer buffer;
+    buffer.setData(data);
+    bool ok = read_parameters(&buffer, parameters);
+    if(!archive.closeRead())
+        return false;
+    return ok;
+};
+
+template<class X>
+bool SemSolver::IO::get_cached_solution_from_workspace(QFile *workspace,
+                                                       const QByteArray &hash,
+                                                       SemSpace<2, X> const &space,
+                                                       Vector<X> &coefficients)
+{
+    QByteArray data;
+    if(!get_cached_solution_from_workspace(workspace, hash, data))
+        return false;
+    SolutionFile solution(data);
+    if(!solution.open())
+        return false;
+    if(solution.nodes()!=(qint64)space.nodes()
+       || solution.elements()!=(qint64)space.subDomains())
+        return false;
+    for(int e=0; e<space.subDomains(); ++e)
+        if(solution.degree(e)!=space.degree(e))
+            return false;
+    coefficients = Vector<X>(solution.nodes());
+    for(int i=0; i<coefficients.rows(); ++i)
+        coefficients[i] = solution.u()[i];
     return true;
 };
 
+template<class X>
+bool SemSolver::IO::add_cached_solution_to_workspace(QFile *workspace,
+                                                     const QByteArray &hash,
+                                                     SemSpace<2, X> const &space,
+                                                     Vector<X> const &coefficients,
+                                                     qint64 const &capacity)
+{
+    QBuffer buffer;
+    if(!write_solution(space, coefficients, &buffer))
+        return false;
+    return add_cached_solution_to_workspace(workspace, hash, buffer.data(), capacity);
+};
+
 #endif // WORKSPACE_HPP
@@ -0,0 +1,197 @@
+#ifndef COMPUTEERRORINDICATORS_HPP
+#define COMPUTEERRORINDICATORS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <SemSolver/gausslobattolegendre.hpp>
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/vector.hpp>
+
+namespace SemSolver
+{
+    namespace PostProcessor
+    {
+        //! Compute the matrix transforming GLL nodal values into Legendre coefficients
+        /*! Its (a, p)-th entry is \f$w_p L_a(x_p) / \gamma_a\f$, \f$\gamma_a\f$ being the
+            discrete norm of \f$L_a\f$ */
+        //! \param N Polynomial degree
+        //! \param transform Vector where to store the (N+1)^2 entries, row by row
+        template<class X>
+        void compute_legendre_transform(int const &N,
+                                        std::vector<X> &transform)
+        {
+            std::vector<X> nodes, weights;
+            compute_gll_nodes_and_weights(N, nodes, weights);
+            transform.resize((N+1)*(N+1));
+            for(int p=0; p<=N; ++p)
+            {
+                X L0 = 1., L1 = nodes[p];
+                for(int a=0; a<=N; ++a)
+                {
+                    X L = a ? L1 : L0;
+                    if(a>1)
+                    {
+                        L = ((2.*a-1.)*nodes[p]*L1 - (a-1.)*L0)/a;
+                        L0 = L1;
+                        L1 = L;
+                    }
+                    X gamma = a<N ? 2./(2.*a+1.) : 2./N;
+                    transform[a*(N+1)+p] = weights[p]*L/gamma;
+                }
+            }
+        };
+
+        /*! Compute the squared L2 norms, on the canonical element, of the terms of the
+            Legendre expansion of a space element on a subdomain of degree N grouped by
+            degree \f$n = \max(a, b)\f$ of the coefficients \f$\hat u_{ab}\f$. It costs
+            O(N^3) operations */
+        //! \param space Space of the element
+        //! \param u Fourier coefficients of the element
+        //! \param element Index of the subdomain
+        //! \param transform Matrix computed by compute_legendre_transform for degree N
+        //! \param energies Vector where to store the N+1 squared norms
+        template<class X>
+        void compute_legendre_energies(const SemSpace<2, X> &space,
+                                       const Vector<X> &u,
+                                       int const &element,
+                                       std::vector<X> const &transform,
+                                       std::vector<X> &energies)
+        {
+            int N = space.degree(element);
+            energies.assign(N+1, 0.);
+            // transform along x, then along y
+            std::vector<X> t((N+1)*(N+1));
+            for(int a=0; a<=N; ++a)
+                for(int k=0; k<=N; ++k)
+                {
+                    X sum = 0.;
+                    for(int j=0; j<=N; ++j)
+                        sum += transform[a*(N+1)+j]*u[space.subDomainIndex(element, j, k)];
+                    t[a*(N+1)+k] = sum;
+                }
+            for(int a=0; a<=N; ++a)
+                for(int b=0; b<=N; ++b)
+                {
+                    X coefficient = 0.;
+                    for(int k=0; k<=N; ++k)
+                        coefficient += transform[b*(N+1)+k]*t[a*(N+1)+k];
+                    energies[std::max(a, b)] += coefficient*coefficient * 2./(2.*a+1.)
+                                                * 2./(2.*b+1.);
+                }
+        };
+
+        /*! Compute an error indicator for each subdomain from the decay of the Legendre
+            coefficients of a space element. Its nodal values on a subdomain are
+            transformed into coefficients \f$\hat u_{ab}\f$ of the tensor products of
+            Legendre polynomials by GLL quadrature, then the indicator is the L2 norm of
+            the terms of highest degree, \f$\max(a, b) = N\f$, which is about the
+            truncation error when coefficients decay fast, scaled by the subdomain
+            area. Subdomains may have different degrees N. It costs O(N^3) operations
+            per subdomain */
+        //! \param space Space of the element
+        //! \param u Fourier coefficients of the element
+        //! \param indicators Vector where to store one indicator for each subdomain
+        template<class X>
+        void compute_error_indicators(const SemSpace<2, X> &space,
+                                      const Vector<X> &u,
+                                      std::vector<X> &indicators)
+        {
+            int M = space.subDomains();
+            indicators.assign(M, 0.);
+            std::vector< std::vector<X> > transforms;
+            std::vector<X> energies;
+            for(int i=0; i<M; ++i)
+            {
+                int N = space.degree(i);
+                if((int)transforms.size()<=N)
+                    transforms.resize(N+1);
+                if(transforms[N].empty())
+                    compute_legendre_transform(N, transforms[N]);
+                compute_legendre_energies(space, u, i, transforms[N], energies);
+                X area = space.map(i).omega().area();
+                indicators[i] = std::sqrt(energies[N]*std::abs(area)/4.);
+            }
+        };
+
+        /*! Compute for each subdomain the rate s of exponential decay of the Legendre
+            coefficients of a space element, fitting \f$e^{-s n}\f$ to the norms of the
+            terms of degree n = 1, ..., N by least squares. Large rates mean that the
+            element is smooth on the subdomain, so that raising its degree pays off
+            more than splitting it */
+        //! \param space Space of the element
+        //! \param u Fourier coefficients of the element
+        //! \param rates Vector where to store one rate for each subdomain
+        template<class X>
+        void compute_decay_rates(const SemSpace<2, X> &space,
+                                 const Vector<X> &u,
+                                 std::vector<X> &rates)
+        {
+            int M = space.subDomains();
+            rates.assign(M, 0.);
+            std::vector< std::vector<X> > transforms;
+            std::vector<X> energies;
+            for(int i=0; i<M; ++i)
+            {
+                int N = space.degree(i);
+                if(N<2)
+                    continue;
+                if((int)transforms.size()<=N)
+                    transforms.resize(N+1);
+                if(transforms[N].empty())
+                    compute_legendre_transform(N, transforms[N]);
+                compute_legendre_energies(space, u, i, transforms[N], energies);
+                X floor = 0.;
+                for(int n=0; n<=N; ++n)
+                    floor = std::max(floor, energies[n]);
+                floor *= 1.e-28;
+                if(floor==0.)
+                    continue;
+                // least squares fit of log of norms = c - s n
+                X sn = 0., sy = 0., snn = 0., sny = 0.;
+                for(int n=1; n<=N; ++n)
+                {
+                    X y = 0.5*std::log(std::max(energies[n], floor));
+                    sn += n;
+                    sy += y;
+                    snn += n*n;
+                    sny += n*y;
+                }
+                rates[i] = -(N*sny - sn*sy)/(N*snn - sn*sn);
+            }
+        };
+
+        /*! Mark subdomains to be refined, so that the marked ones account for a
+            fraction of the total squared error indicator, choosing the subdomains with
+            largest indicators first (Dorfler marking) */
+        //! \param indicators Error indicator of each subdomain
+        //! \param fraction Fraction of the total squared indicator, in [0, 1]
+        //! \param marked Vector where to store a mark for each subdomain
+        template<class X>
+        void compute_refinement_marks(std::vector<X> const &indicators,
+                                      X const &fraction,
+                                      std::vector<bool> &marked)
+        {
+            unsigned M = indicators.size();
+            marked.assign(M, false);
+            std::vector< std::pair<X, unsigned> > sorted(M);
+            X total = 0.;
+            for(unsigned i=0; i<M; ++i)
+            {
+                sorted[i] = std::make_pair(-indicators[i]*indicators[i], i);
+                total += indicators[i]*indicators[i];
+            }
+            std::sort(sorted.begin(), sorted.end());
+            X sum = 0.;
+            for(unsigned k=0; k<M && sum<fraction*total; ++k)
+            {
+                marked[sorted[k].second] = true;
+                sum -= sorted[k].first;
+            }
+        };
+    };
+};
+
+#endif // COMPUTEERRORINDICATORS_HPP
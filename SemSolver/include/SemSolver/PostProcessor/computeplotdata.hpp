@@ -2,6 +2,7 @@
 #define COMPUTEPLOTDATA_HPP
 
 #include <SemSolver/semspace.hpp>
+#include <SemSolver/PostProcessor/computeplotcells.hpp>
 #include <SemSolver/vector.hpp>
 
 #include <qwt3d_types.h>
@@ -19,31 +20,15 @@ namespace SemSolver
         {
             for(int i=0; i<u.rows(); ++i)
                 data.push_back(Qwt3D::Triple(space.node(i).point().x(), space.node(i).point().y(), u[i]));
+            int cell[4];
             for(int i=0; i<space.subDomains(); ++i)
             {
-                for(int j=0; j<space.degree(); ++j)
+                for(int j=0; j<space.degree(i); ++j)
                 {
-                    for(int k=0; k<space.degree(); ++k)
+                    for(int k=0; k<space.degree(i); ++k)
                     {
-                        Qwt3D::Cell cell;
-                        MultiIndex<3> mi;
-                        mi.setSubIndex(0,i);
-                        mi.setSubIndex(1,j);
-                        mi.setSubIndex(2,k);
-                        cell.push_back(space.subDomainIndex(mi));
-                        mi.setSubIndex(0,i);
-                        mi.setSubIndex(1,j+1);
-                        mi.setSubIndex(2,k);
-                        cell.push_back(space.subDomainIndex(mi));
-                        mi.setSubIndex(0,i);
-                        mi.setSubIndex(1,j+1);
-                        mi.setSubIndex(2,k+1);
-                        cell.push_back(space.subDomainIndex(mi));
-                        mi.setSubIndex(0,i);
-                        mi.setSubIndex(1,j);
-                        mi.setSubIndex(2,k+1);
-                        cell.push_back(space.subDomainIndex(mi));
-                        poly.push_back(cell);
+                        compute_plot_cell(space, i, j, k, cell);
+                        poly.push_back(Qwt3D::Cell(cell, cell+4));
                     }
                 }
             }
@@ -0,0 +1,58 @@
+#ifndef COMPUTEPSLGHASH_HPP
+#define COMPUTEPSLGHASH_HPP
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QString>
+
+#include <SemSolver/pslg.hpp>
+
+namespace SemSolver
+{
+    //! \brief PreProcessor namespace
+    /*! This namespace provides algorithms for the constuction of the geometric structures
+        associated to the problem from geometric information stored in PSLG format. */
+    namespace PreProcessor
+    {
+        //! Compute a content hash of the inputs a polygonation of a PSLG depends on
+        /*! Vertices, segments and holes are hashed together with the options of the
+            mesher, so that two PSLGs with the same hash give the same polygonation and
+            a cached one can be reused. The mesher output is refined once when it is not
+            a quadrangulation, which only depends on these inputs, so the refinement
+            needs not to be hashed */
+        //! \param pslg Geometry of the domain
+        //! \param size Element size of compute_quadrangulation_from_pslg, 0 for
+        //! compute_polygonation_from_pslg
+        //! \return SHA-1 digest
+        template<class X>
+        QByteArray compute_pslg_hash(PSLG<X> const &pslg,
+                                     X const &size)
+        {
+            QByteArray data;
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream.setByteOrder(QDataStream::LittleEndian);
+            stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+            stream << QString("SemSolver polygonation 2");
+
+            stream << (quint32)pslg.vertices();
+            for(unsigned i=0; i<pslg.vertices(); ++i)
+                stream << (qint32)pslg.vertex(i).number
+                       << (double)pslg.vertex(i).x << (double)pslg.vertex(i).y;
+            stream << (quint32)pslg.segments();
+            for(unsigned i=0; i<pslg.segments(); ++i)
+                stream << (qint32)pslg.segment(i).number
+                       << (qint32)pslg.segment(i).source
+                       << (qint32)pslg.segment(i).target;
+            stream << (quint32)pslg.holes();
+            for(unsigned i=0; i<pslg.holes(); ++i)
+                stream << (double)pslg.hole(i).x << (double)pslg.hole(i).y;
+
+            stream << (double)size;
+
+            return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        };
+    }
+}
+
+#endif // COMPUTEPSLGHASH_HPP
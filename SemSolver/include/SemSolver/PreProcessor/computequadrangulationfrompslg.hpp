@@ -0,0 +1,243 @@
+#ifndef COMPUTEQUADRANGULATIONFROMPSLG_HPP
+#define COMPUTEQUADRANGULATIONFROMPSLG_HPP
+
+#ifdef __GNUC__
+#  ifdef __GLIBC__
+#    if ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 1)))
+#      include <stdint.h>
+#    endif
+#  endif
+#endif
+
+#if defined _WIN32 || defined _WIN64
+#  undef max
+#  include <limits>
+#endif
+
+#include <cmath>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <CGAL/Cartesian.h>
+#include <CGAL/Filtered_kernel.h>
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Delaunay_mesher_2.h>
+#include <CGAL/Delaunay_mesh_face_base_2.h>
+#include <CGAL/Delaunay_mesh_size_criteria_2.h>
+#include <CGAL/Triangulation_face_base_with_info_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <SemSolver/point.hpp>
+#include <SemSolver/polygon.hpp>
+#include <SemSolver/polygonation.hpp>
+#include <SemSolver/polygonwithholes.hpp>
+#include <SemSolver/pslg.hpp>
+#include <SemSolver/PreProcessor/computepolygonwithholesfrompslg.hpp>
+
+namespace SemSolver
+{
+    //! \brief PreProcessor namespace
+    /*! This namespace provides algorithms for the constuction of the geometric structures
+        associated to the problem from geometric information stored in PSLG format. */
+    namespace PreProcessor
+    {
+        /*! Compute a quadrangulation of a 2D geometry defined as a Planar Straight Line
+            Graph, with elements of a given size.
+
+            The domain is meshed by constrained Delaunay refinement, with angles of
+            triangles bounded from below by about 20 degrees and edges shorter than
+            twice size, then each triangle is split into three quadrangles joining its
+            centroid to the midpoints of its edges. Midpoints are shared by adjacent
+            triangles, so the quadrangulation is conforming and its angles are bounded
+            away from 0 and 180 degrees. Neighbour ids follow the same convention as
+            compute_polygonation_from_pslg and Polygonation::refine, a border edge being
+            given the id minus one minus the position of the PSLG segment it lies on.
+
+            Meshing takes O(M log M) time for M elements, neighbours are found in
+            constant time from the triangulation adjacency. */
+        //! \param pslg Geometry of the domain, holes are marked by PSLG holes
+        //! \param size Upper bound for the length of the sides of quadrangles
+        //! \param polygonation Polygonation reference to the computed quadrangulation
+        template<class X>
+        bool compute_quadrangulation_from_pslg(const PSLG<X> &pslg,
+                                               X const &size,
+                                               Polygonation<2,X> &polygonation)
+        {
+            typedef CGAL::Filtered_kernel< CGAL::Simple_cartesian<X> > Kernel;
+            typedef CGAL::Triangulation_vertex_base_with_info_2<int, Kernel> Vb;
+            typedef CGAL::Triangulation_face_base_with_info_2<int, Kernel> Fbi;
+            typedef CGAL::Constrained_triangulation_face_base_2<Kernel, Fbi> Fbc;
+            typedef CGAL::Delaunay_mesh_face_base_2<Kernel, Fbc> Fb;
+            typedef CGAL::Triangulation_data_structure_2<Vb, Fb> Tds;
+            typedef CGAL::Constrained_Delaunay_triangulation_2<Kernel, Tds> CDT;
+            typedef CGAL::Delaunay_mesh_size_criteria_2<CDT> Criteria;
+
+            typedef typename CDT::Point Cdt_point;
+            typedef typename CDT::Vertex_handle Vertex_handle;
+            typedef typename CDT::Face_handle Face_handle;
+            typedef typename CDT::Edge_circulator Edge_circulator;
+            typedef typename CDT::Finite_vertices_iterator Vertex_iterator;
+            typedef typename CDT::Finite_faces_iterator Face_iterator;
+            typedef std::map< std::pair<int,int>, int > EdgeIdsMap;
+            typedef typename EdgeIdsMap::value_type Pair;
+
+            polygonation.clear();
+            if(!(size>X(0)))
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::PreProcessor::compute_quadrangulation_from_pslg - ERR"\
+                         "OR : element size must be positive.");
+#endif
+                return false;
+            }
+            PolygonWithHoles<2,X> domain;
+            if(!compute_polygon_with_holes_from_pslg(pslg, domain))
+                return false;
+
+            // constrained triangulation of the PSLG
+
+            CDT cdt;
+            std::map<int, Vertex_handle> vertices_map;
+            for(unsigned i=0; i<pslg.vertices(); ++i)
+                vertices_map[pslg.vertex(i).number] =
+                        cdt.insert(Cdt_point(pslg.vertex(i).x, pslg.vertex(i).y));
+            std::vector< std::pair<Vertex_handle, Vertex_handle> > segments;
+            for(unsigned i=0; i<pslg.segments(); ++i)
+            {
+                Vertex_handle source = vertices_map[pslg.segment(i).source];
+                Vertex_handle target = vertices_map[pslg.segment(i).target];
+                segments.push_back(std::make_pair(source, target));
+                cdt.insert_constraint(source, target);
+            }
+
+            // Delaunay refinement, faces reachable from holes are left out of the domain
+
+            std::list<Cdt_point> seeds;
+            for(unsigned i=0; i<pslg.holes(); ++i)
+                seeds.push_back(Cdt_point(pslg.hole(i).x, pslg.hole(i).y));
+            CGAL::refine_Delaunay_mesh_2(cdt, seeds.begin(), seeds.end(),
+                                         Criteria(0.125, 2*size));
+
+            int index = 0;
+            for(Vertex_iterator it = cdt.finite_vertices_begin();
+            it != cdt.finite_vertices_end(); ++it)
+                it->info() = index++;
+            int triangles = 0;
+            for(Face_iterator it = cdt.finite_faces_begin();
+            it != cdt.finite_faces_end(); ++it)
+                it->info() = it->is_in_domain() ? triangles++ : -1;
+            for(typename CDT::All_faces_iterator it = cdt.all_faces_begin();
+            it != cdt.all_faces_end(); ++it)
+                if(cdt.is_infinite(it))
+                    it->info() = -1;
+
+            // walk each segment along its constrained subedges to get border ids
+
+            EdgeIdsMap border_id;
+            for(unsigned i=0; i<segments.size(); ++i)
+            {
+                Vertex_handle v = segments[i].first;
+                Vertex_handle target = segments[i].second;
+                while(v!=target)
+                {
+                    Cdt_point const &p = v->point();
+                    Cdt_point const &q = target->point();
+                    X distance = std::sqrt(CGAL::squared_distance(p, q));
+                    Vertex_handle next;
+                    X best = X(0);
+                    Edge_circulator edge = cdt.incident_edges(v);
+                    Edge_circulator end = edge;
+                    do
+                    {
+                        if(cdt.is_infinite(*edge) || !cdt.is_constrained(*edge))
+                            continue;
+                        Face_handle face = edge->first;
+                        Vertex_handle w = face->vertex(cdt.ccw(edge->second));
+                        if(w==v)
+                            w = face->vertex(cdt.cw(edge->second));
+                        X length = std::sqrt(CGAL::squared_distance(p, w->point()));
+                        X cosine = ((w->point()-p)*(q-p)) / (length*distance);
+                        if(cosine>best && length<=distance)
+                        {
+                            best = cosine;
+                            next = w;
+                        }
+                    }
+                    while(++edge!=end);
+                    if(best<X(0.5))
+                    {
+#ifdef SEMDEBUG
+                        qWarning("SemSolver::PreProcessor::compute_quadrangulation_from_ps"\
+                                 "lg - ERROR : lost segment in triangulation.");
+#endif
+                        polygonation.clear();
+                        return false;
+                    }
+                    border_id.insert(Pair(std::make_pair(std::min(v->info(), next->info()),
+                                                         std::max(v->info(), next->info())),
+                                          -(int)i-1));
+                    v = next;
+                }
+            }
+
+            // split each triangle into quadrangles, one for each vertex
+
+            polygonation.reserve(3*triangles);
+            for(Face_iterator it = cdt.finite_faces_begin();
+            it != cdt.finite_faces_end(); ++it)
+            {
+                if(it->info()<0)
+                    continue;
+                int first = 3*it->info();
+                Point<2,X> cent = CGAL::centroid(it->vertex(0)->point(),
+                                                 it->vertex(1)->point(),
+                                                 it->vertex(2)->point());
+                for(int j=0; j<3; ++j)
+                {
+                    Vertex_handle a = it->vertex(j);
+                    Vertex_handle b = it->vertex(cdt.ccw(j));
+                    Vertex_handle c = it->vertex(cdt.cw(j));
+                    Polygon<2,X> polygon;
+                    polygon.push_back(a->point());
+                    polygon.push_back(CGAL::midpoint(a->point(), b->point()));
+                    polygon.push_back(cent);
+                    polygon.push_back(CGAL::midpoint(a->point(), c->point()));
+                    std::vector<int> neighbours(4);
+                    // neighbours across edges c-a and a-b, opposite to b and c
+                    Vertex_handle opposite[2] = {b, c};
+                    Vertex_handle other[2] = {c, b};
+                    for(int k=0; k<2; ++k)
+                    {
+                        Face_handle face = it->neighbor(it->index(opposite[k]));
+                        if(face->info()>=0)
+                            neighbours[k] = 3*face->info()+face->index(a)+1;
+                        else
+                        {
+                            typename EdgeIdsMap::const_iterator id = border_id.find(
+                                    std::make_pair(std::min(a->info(), other[k]->info()),
+                                                   std::max(a->info(), other[k]->info())));
+                            if(id==border_id.end())
+                            {
+#ifdef SEMDEBUG
+                                qWarning("SemSolver::PreProcessor::compute_quadrangulation"\
+                                         "_from_pslg - ERROR : domain is not bounded by s"\
+                                         "egments.");
+#endif
+                                polygonation.clear();
+                                return false;
+                            }
+                            neighbours[k] = id->second;
+                        }
+                    }
+                    neighbours[2] = first+cdt.ccw(j)+1;
+                    neighbours[3] = first+cdt.cw(j)+1;
+                    polygonation.addElement(polygon, neighbours);
+                }
+            }
+            return true;
+        }
+    }
+}
+
+#endif // COMPUTEQUADRANGULATIONFROMPSLG_HPP
@@ -0,0 +1,410 @@
+#ifndef SMOOTHPOLYGONATION_HPP
+#define SMOOTHPOLYGONATION_HPP
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <SemSolver/point.hpp>
+#include <SemSolver/polygonation.hpp>
+
+namespace SemSolver
+{
+    //! \brief PreProcessor namespace
+    /*! This namespace provides algorithms for the constuction of the geometric structures
+        associated to the problem from geometric information stored in PSLG format. */
+    namespace PreProcessor
+    {
+        //! Vertices of a Polygonation shared among its elements
+        /*! Vertices of element i are element_vertices[k] for k from element_first[i]
+            to element_first[i+1]-1, and elements of vertex v are vertex_elements[k]
+            for k from vertex_first[v] to vertex_first[v+1]-1 */
+        template<class X>
+        struct PolygonationVertices
+        {
+            std::vector< Point<2,X> > points;
+            //! Vertices on the border or on nonconforming edges, which must not move
+            std::vector<bool>         fixed;
+            std::vector<unsigned>     element_first;
+            std::vector<unsigned>     element_vertices;
+            std::vector<unsigned>     vertex_first;
+            std::vector<unsigned>     vertex_elements;
+
+            //! Get number of vertices
+            inline unsigned size() const
+            {
+                return points.size();
+            };
+        };
+
+        //! Range of positions in a vector of indices
+        struct SmoothingRange
+        {
+            unsigned first;
+            unsigned last;
+        };
+
+        //! Compute scaled Jacobian of a corner of a counterclockwise polygon
+        /*! It is the sine of the angle at the corner, positive if it is convex,
+            -1 if an edge is degenerate */
+        template<class X>
+        inline X compute_corner_quality(Point<2,X> const &previous,
+                                        Point<2,X> const &corner,
+                                        Point<2,X> const &next)
+        {
+            X ux = next.x()-corner.x(), uy = next.y()-corner.y();
+            X wx = previous.x()-corner.x(), wy = previous.y()-corner.y();
+            X length = std::sqrt((ux*ux+uy*uy)*(wx*wx+wy*wy));
+            if(length==X(0))
+                return -1.;
+            return (ux*wy-uy*wx)/length;
+        };
+
+        /*! Compute quality of an element as the minimum scaled Jacobian of its corners.
+            It is 1 for rectangles, and positive if and only if the element is convex,
+            so that the bilinear map of a quadrangle is invertible */
+        template<class X>
+        X compute_element_quality(typename Polygonation<2,X>::Element const &element)
+        {
+            int n = element.size();
+            X quality = 1.;
+            for(int j=0; j<n; ++j)
+                quality = std::min(quality,
+                                   compute_corner_quality(element.vertex((j+n-1)%n),
+                                                          element.vertex(j),
+                                                          element.vertex((j+1)%n)));
+            return quality;
+        };
+
+        //! Compute quality of the elements of a range
+        template<class X>
+        struct ComputeElementQualities
+        {
+            typedef void result_type;
+
+            Polygonation<2,X> const *polygonation;
+            std::vector<X> *qualities;
+
+            void operator()(SmoothingRange const &range) const
+            {
+                for(unsigned i=range.first; i<range.last; ++i)
+                    (*qualities)[i] = compute_element_quality<X>(polygonation->element(i));
+            };
+        };
+
+        //! Split n indices in ranges for the global thread pool
+        inline void compute_smoothing_ranges(unsigned const &n,
+                                             QVector<SmoothingRange> &ranges)
+        {
+            ranges.clear();
+            unsigned chunks = 4*QThread::idealThreadCount();
+            if(chunks<1)
+                chunks = 1;
+            unsigned chunk_size = (n+chunks-1)/chunks;
+            for(unsigned begin=0; begin<n; begin+=chunk_size)
+            {
+                SmoothingRange range = { begin, std::min(begin+chunk_size, n) };
+                ranges.push_back(range);
+            }
+        };
+
+        //! Compute quality of each element of a Polygonation in parallel
+        //! see compute_element_quality
+        template<class X>
+        void compute_element_qualities(Polygonation<2,X> const &polygonation,
+                                       std::vector<X> &qualities)
+        {
+            qualities.resize(polygonation.size());
+            QVector<SmoothingRange> ranges;
+            compute_smoothing_ranges(polygonation.size(), ranges);
+            ComputeElementQualities<X> compute;
+            compute.polygonation = &polygonation;
+            compute.qualities = &qualities;
+            QtConcurrent::blockingMap(ranges, compute);
+        };
+
+        //! Count element qualities in bins of equal width over [-1, 1]
+        //! \param qualities Quality of each element, see compute_element_qualities
+        //! \param bins Number of bins
+        //! \param histogram Vector where to store the count of each bin
+        template<class X>
+        void compute_quality_histogram(std::vector<X> const &qualities,
+                                       unsigned const &bins,
+                                       std::vector<unsigned> &histogram)
+        {
+            histogram.assign(bins, 0);
+            for(unsigned i=0; i<qualities.size(); ++i)
+            {
+                int bin = (int)std::floor((qualities[i]+1.)/2.*bins);
+                ++histogram[std::max(0, std::min(bin, (int)bins-1))];
+            }
+        };
+
+        /*! Compute shared vertices of a Polygonation. Vertices are merged by their
+            coordinates, as shared vertices are equal in all their elements. Vertices of
+            border edges and of nonconforming edges are fixed */
+        template<class X>
+        void compute_polygonation_vertices(Polygonation<2,X> const &polygonation,
+                                           PolygonationVertices<X> &vertices)
+        {
+            typedef std::map< std::pair<X,X>, unsigned > VerticesMap;
+            VerticesMap ids;
+            unsigned M = polygonation.size();
+            vertices.points.clear();
+            vertices.fixed.clear();
+            vertices.element_first.assign(1, 0);
+            vertices.element_vertices.clear();
+            for(unsigned i=0; i<M; ++i)
+            {
+                typename Polygonation<2,X>::Element const &element = polygonation.element(i);
+                int n = element.size();
+                for(int j=0; j<n; ++j)
+                {
+                    Point<2,X> const point = element.vertex(j);
+                    std::pair<typename VerticesMap::iterator, bool> inserted =
+                            ids.insert(std::make_pair(std::make_pair(point.x(), point.y()),
+                                                      (unsigned)vertices.points.size()));
+                    if(inserted.second)
+                    {
+                        vertices.points.push_back(point);
+                        vertices.fixed.push_back(false);
+                    }
+                    vertices.element_vertices.push_back(inserted.first->second);
+                }
+                // edge j goes from vertex j-1 to vertex j
+                unsigned first = vertices.element_first.back();
+                for(int j=0; j<n; ++j)
+                {
+                    bool half;
+                    if(element.neighbour(j)<=0 || polygonation.facingEdge(i, j, half)<0
+                       || half)
+                    {
+                        vertices.fixed[vertices.element_vertices[first+(j+n-1)%n]] = true;
+                        vertices.fixed[vertices.element_vertices[first+j]] = true;
+                    }
+                }
+                vertices.element_first.push_back(vertices.element_vertices.size());
+            }
+
+            // elements of each vertex, counting sort
+            unsigned V = vertices.size();
+            vertices.vertex_first.assign(V+1, 0);
+            for(unsigned k=0; k<vertices.element_vertices.size(); ++k)
+                ++vertices.vertex_first[vertices.element_vertices[k]+1];
+            for(unsigned v=0; v<V; ++v)
+                vertices.vertex_first[v+1] += vertices.vertex_first[v];
+            vertices.vertex_elements.resize(vertices.vertex_first[V]);
+            std::vector<unsigned> fill(vertices.vertex_first.begin(),
+                                       vertices.vertex_first.end()-1);
+            for(unsigned i=0; i<M; ++i)
+                for(unsigned k=vertices.element_first[i]; k<vertices.element_first[i+1]; ++k)
+                    vertices.vertex_elements[fill[vertices.element_vertices[k]]++] = i;
+        };
+
+        //! Optimize positions of a range of vertices, no two of which share an element
+        /*! Each vertex is first moved to the average of its neighbours along edges
+            (Laplacian smoothing) unless that lowers the quality of its elements, then
+            a pattern search moves it towards the maximum of the minimum scaled Jacobian
+            of its elements */
+        template<class X>
+        struct OptimizeVertices
+        {
+            typedef void result_type;
+
+            PolygonationVertices<X> *vertices;
+            std::vector<unsigned> const *colour;
+
+            //! Get quality of an element with vertex v moved to point
+            X quality(unsigned const &element,
+                      unsigned const &v,
+                      Point<2,X> const &point) const
+            {
+                unsigned first = vertices->element_first[element];
+                unsigned n = vertices->element_first[element+1]-first;
+                std::vector< Point<2,X> > const &points = vertices->points;
+                std::vector<unsigned> const &ids = vertices->element_vertices;
+                X result = 1.;
+                for(unsigned j=0; j<n; ++j)
+                {
+                    unsigned a = ids[first+(j+n-1)%n];
+                    unsigned b = ids[first+j];
+                    unsigned c = ids[first+(j+1)%n];
+                    result = std::min(result, compute_corner_quality(
+                            a==v ? point : points[a],
+                            b==v ? point : points[b],
+                            c==v ? point : points[c]));
+                }
+                return result;
+            };
+
+            //! Get minimum quality of the elements of vertex v moved to point
+            X vertexQuality(unsigned const &v, Point<2,X> const &point) const
+            {
+                X result = 1.;
+                for(unsigned k=vertices->vertex_first[v]; k<vertices->vertex_first[v+1]; ++k)
+                    result = std::min(result, quality(vertices->vertex_elements[k], v, point));
+                return result;
+            };
+
+            void operator()(SmoothingRange const &range) const
+            {
+                static const X cosines[8] = {1., 0.7071067811865476, 0.,
+                                             -0.7071067811865476, -1.,
+                                             -0.7071067811865476, 0.,
+                                             0.7071067811865476};
+                std::vector< Point<2,X> > &points = vertices->points;
+                for(unsigned r=range.first; r<range.last; ++r)
+                {
+                    unsigned v = (*colour)[r];
+                    Point<2,X> best = points[v];
+                    X best_quality = vertexQuality(v, best);
+
+                    // Laplacian smoothing
+                    X x = 0., y = 0., h = -1.;
+                    unsigned count = 0;
+                    for(unsigned k=vertices->vertex_first[v];
+                    k<vertices->vertex_first[v+1]; ++k)
+                    {
+                        unsigned element = vertices->vertex_elements[k];
+                        unsigned first = vertices->element_first[element];
+                        unsigned n = vertices->element_first[element+1]-first;
+                        for(unsigned j=0; j<n; ++j)
+                        {
+                            if(vertices->element_vertices[first+j]!=v)
+                                continue;
+                            for(int s=-1; s<=1; s+=2)
+                            {
+                                Point<2,X> const &neighbour = points[
+                                        vertices->element_vertices[first+(j+n+s)%n]];
+                                x += neighbour.x();
+                                y += neighbour.y();
+                                ++count;
+                                X dx = neighbour.x()-best.x(), dy = neighbour.y()-best.y();
+                                X length = std::sqrt(dx*dx+dy*dy);
+                                if(h<0. || length<h)
+                                    h = length;
+                            }
+                        }
+                    }
+                    if(!count)
+                        continue;
+                    Point<2,X> laplacian(x/count, y/count);
+                    X laplacian_quality = vertexQuality(v, laplacian);
+                    if(laplacian_quality>=best_quality)
+                    {
+                        best = laplacian;
+                        best_quality = laplacian_quality;
+                    }
+
+                    // pattern search of the maximum scaled Jacobian
+                    h *= 0.25;
+                    for(int step=0; step<8; ++step)
+                    {
+                        Point<2,X> candidate_best = best;
+                        X candidate_quality = best_quality;
+                        for(int d=0; d<8; ++d)
+                        {
+                            Point<2,X> candidate(best.x()+h*cosines[d],
+                                                 best.y()+h*cosines[(d+6)%8]);
+                            X q = vertexQuality(v, candidate);
+                            if(q>candidate_quality)
+                            {
+                                candidate_best = candidate;
+                                candidate_quality = q;
+                            }
+                        }
+                        if(candidate_quality>best_quality)
+                        {
+                            best = candidate_best;
+                            best_quality = candidate_quality;
+                        }
+                        else
+                            h *= 0.5;
+                    }
+                    points[v] = best;
+                }
+            };
+        };
+
+        /*! Optimize interior vertices of a Polygonation, keeping border vertices and
+            vertices of nonconforming edges fixed, see compute_polygonation_vertices.
+            Each iteration applies Laplacian smoothing and a pattern search maximizing
+            the minimum scaled Jacobian of the elements of each vertex, see
+            OptimizeVertices, so that element qualities never decrease. Vertices are
+            coloured so that no two vertices of one color share an element, then the
+            vertices of each color are moved in parallel. Coarse levels of the hierarchy
+            are left unchanged */
+        //! \param polygonation The Polygonation to smooth
+        //! \param iterations Number of sweeps over all vertices
+        //! \return true if all elements are convex, see compute_element_quality
+        template<class X>
+        bool smooth_polygonation(Polygonation<2,X> &polygonation,
+                                 unsigned const &iterations = 5)
+        {
+            PolygonationVertices<X> vertices;
+            compute_polygonation_vertices(polygonation, vertices);
+            unsigned V = vertices.size();
+
+            // greedy colouring of free vertices
+            std::vector<int> colours(V, -1);
+            std::vector< std::vector<unsigned> > coloured;
+            std::vector<bool> used;
+            for(unsigned v=0; v<V; ++v)
+            {
+                if(vertices.fixed[v])
+                    continue;
+                used.assign(coloured.size()+1, false);
+                for(unsigned k=vertices.vertex_first[v]; k<vertices.vertex_first[v+1]; ++k)
+                {
+                    unsigned element = vertices.vertex_elements[k];
+                    for(unsigned l=vertices.element_first[element];
+                    l<vertices.element_first[element+1]; ++l)
+                    {
+                        int colour = colours[vertices.element_vertices[l]];
+                        if(colour>=0)
+                            used[colour] = true;
+                    }
+                }
+                unsigned colour = std::find(used.begin(), used.end(), false) - used.begin();
+                if(colour==coloured.size())
+                    coloured.push_back(std::vector<unsigned>());
+                colours[v] = colour;
+                coloured[colour].push_back(v);
+            }
+
+            OptimizeVertices<X> optimize;
+            optimize.vertices = &vertices;
+            QVector<SmoothingRange> ranges;
+            for(unsigned iteration=0; iteration<iterations; ++iteration)
+            {
+                for(unsigned c=0; c<coloured.size(); ++c)
+                {
+                    optimize.colour = &coloured[c];
+                    compute_smoothing_ranges(coloured[c].size(), ranges);
+                    QtConcurrent::blockingMap(ranges, optimize);
+                }
+            }
+
+            // move vertices of elements
+            X worst = 1.;
+            std::vector< Point<2,X> > points;
+            for(unsigned i=0; i<polygonation.size(); ++i)
+            {
+                points.clear();
+                for(unsigned k=vertices.element_first[i]; k<vertices.element_first[i+1]; ++k)
+                    points.push_back(vertices.points[vertices.element_vertices[k]]);
+                polygonation.setElementGeometry(i, &points[0], &points[0]+points.size());
+                worst = std::min(worst, compute_element_quality<X>(polygonation.element(i)));
+            }
+            return worst>0.;
+        };
+    }
+}
+
+#endif // SMOOTHPOLYGONATION_HPP
@@ -0,0 +1,504 @@
+#ifndef MULTIGRID_HPP
+#define MULTIGRID_HPP
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <SemSolver/matrix.hpp>
+#include <SemSolver/polygonation.hpp>
+#include <SemSolver/problem.hpp>
+#include <SemSolver/semgeometry.hpp>
+#include <SemSolver/semspace.hpp>
+#include <SemSolver/vector.hpp>
+#include <SemSolver/Solver/factorization.hpp>
+
+namespace SemSolver
+{
+    //! Solver namespace
+    /*! This namespace provides algorithms for solving an algebraic system A*x=b */
+    namespace Solver
+    {
+        //! Class for geometric h-multigrid on the hierarchy of a refined Polygonation
+        /*! A space of the degree parameter is built on each coarser level of the
+            hierarchy kept by Polygonation::refine, and nodal values are interpolated
+            from the parent subdomain of each node. Subdomains split by refine are the
+            images of quarters of the reference square by the map of their parent, so
+            that coarse spaces are nested and prolongation is exact; vertices moved
+            after refining, e.g. by PreProcessor::smooth_polygonation, break this and
+            prolongation is then only an interpolation. Coarse matrices are the
+            Galerkin products P'*A*P of the finer ones, the coarsest one is factorized
+            and solved directly, and symmetric Gauss-Seidel sweeps smooth the other
+            levels of each V-cycle. On nested spaces the convergence rate of V-cycles
+            does not depend on the number of levels. A Polygonation without hierarchy
+            gives a single level, that is a direct solve. */
+        template<class X>
+        class Multigrid
+        {
+        public:
+            //! Nodal value of a fine space as pairs of coarse node index and weight
+            typedef std::vector< std::pair<int, X> > Interpolation;
+
+        private:
+            //! Level of the hierarchy, from the coarsest one
+            struct Level
+            {
+                //! System matrix
+                Matrix<X> matrix;
+                //! Interpolation of each node from the next coarser level
+                std::vector<Interpolation> prolongation;
+            };
+
+            std::vector<Level> _levels;
+            Factorization<X>   coarse;
+            int                _smoothing;
+            int                _cycles;
+            X                  _residual;
+
+            //! Add weight of a coarse node to an interpolation, substituting hanging
+            //! coarse nodes with their constraint
+            static void addToInterpolation(SemSpace<2, X> const &space,
+                                           Interpolation &interpolation,
+                                           int const &index,
+                                           X const &weight);
+
+            //! Compute interpolation of the nodes of fine space from coarse space
+            //! \param hierarchy Polygonation whose level level holds fine subdomains
+            //! \param level Level of fine subdomains, 0 if they are the subdomains of
+            //! coarse space
+            static void computeProlongation(Polygonation<2, X> const &hierarchy,
+                                            unsigned const &level,
+                                            SemSpace<2, X> const &coarse_space,
+                                            SemSpace<2, X> const &fine_space,
+                                            std::vector<Interpolation> &prolongation);
+
+            //! Compute Galerkin product P'*A*P for a sparse P
+            static void computeCoarseMatrix(Matrix<X> const &A,
+                                            std::vector<Interpolation> const &prolongation,
+                                            int const &coarse_size,
+                                            Matrix<X> &coarse_matrix);
+
+            //! Apply symmetric Gauss-Seidel sweeps on a level
+            void smooth(int const &level, Vector<X> const &b, Vector<X> &x) const;
+
+            //! Apply a V-cycle from a level
+            void cycle(int const &level, Vector<X> const &b, Vector<X> &x) const;
+
+        public:
+            //! Construct an empty multigrid
+            Multigrid()
+                : _smoothing(2),
+                _cycles(0),
+                _residual(0.)
+            {
+            };
+
+            //! Build levels and coarse matrices of a system
+            /*! Subdomains of the geometry of space must carry the refinement
+                hierarchy, their current level being the one space is built on */
+            //! \param problem Problem of the system
+            //! \param space Space of the system
+            //! \param A Matrix of the system, e.g. by compute_algebraic_system
+            //! \param smoothing Number of pre and post smoothing sweeps
+            //! \return false if a diagonal entry is zero or the coarsest matrix is
+            //! singular
+            bool setup(Problem<2, X> const &problem,
+                       SemSpace<2, X> const &space,
+                       Matrix<X> const &A,
+                       int const &smoothing = 2);
+
+            //! Solve A*x=b by V-cycles
+            //! \param b Constant term
+            //! \param x Initial guess, zero if it does not match b, and solution
+            //! \param tolerance Target residual norm, relative to the norm of b
+            //! \param max_cycles Maximum number of V-cycles
+            //! \return false if tolerance is not reached
+            bool solve(Vector<X> const &b,
+                       Vector<X> &x,
+                       X const &tolerance = 1.e-10,
+                       int const &max_cycles = 100);
+
+            //! Interpolate a solution onto a space refined from its one
+            /*! Subdomains of the geometry of fine space must carry the refinement
+                hierarchy, their previous level being the subdomains of coarse space, or
+                be the same as them if only degrees were raised. Hanging nodes get zero,
+                as in solutions of the condensed system, so that the result can be the
+                initial guess of solve */
+            //! \param coarse_space Space of the solution
+            //! \param coarse_x Solution
+            //! \param fine_space Refined space
+            //! \param fine_x Vector where to store the interpolated solution
+            static void interpolate(SemSpace<2, X> const &coarse_space,
+                                    Vector<X> const &coarse_x,
+                                    SemSpace<2, X> const &fine_space,
+                                    Vector<X> &fine_x);
+
+            //! Apply one V-cycle to a residual from a zero guess
+            /*! It is an approximate inverse of A, to be used as a preconditioner */
+            void precondition(Vector<X> const &r, Vector<X> &z) const;
+
+            //! Get number of levels
+            inline int levels() const
+            {
+                return _levels.size();
+            };
+
+            //! Get number of V-cycles of the last solve
+            inline int cycles() const
+            {
+                return _cycles;
+            };
+
+            //! Get relative residual norm of the last solve
+            inline X const &residual() const
+            {
+                return _residual;
+            };
+        };
+    };
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::addToInterpolation(SemSpace<2, X> const &space,
+                                                         Interpolation &interpolation,
+                                                         int const &index,
+                                                         X const &weight)
+{
+    if(space.isConstrained(index))
+    {
+        typename SemSpace<2, X>::Constraint const &constraint = space.constraint(index);
+        for(unsigned q=0; q<constraint.size(); ++q)
+            addToInterpolation(space, interpolation, constraint[q].first,
+                               weight*constraint[q].second);
+        return;
+    }
+    for(unsigned q=0; q<interpolation.size(); ++q)
+    {
+        if(interpolation[q].first==index)
+        {
+            interpolation[q].second += weight;
+            return;
+        }
+    }
+    interpolation.push_back(std::make_pair(index, weight));
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::computeProlongation(
+        Polygonation<2, X> const &hierarchy,
+        unsigned const &level,
+        SemSpace<2, X> const &coarse_space,
+        SemSpace<2, X> const &fine_space,
+        std::vector<Interpolation> &prolongation)
+{
+    prolongation.assign(fine_space.nodes(), Interpolation());
+    std::vector<bool> done(fine_space.nodes(), false);
+    std::vector<X> lx, ly;
+    for(int e=0; e<fine_space.subDomains(); ++e)
+    {
+        int p = level ? hierarchy.parent(level, e) : e;
+        int N = fine_space.degree(e);
+        int Nc = coarse_space.degree(p);
+        for(int k=0; k<=N; ++k)
+        {
+            for(int j=0; j<=N; ++j)
+            {
+                int I = fine_space.subDomainIndex(e, j, k);
+                if(done[I])
+                    continue;
+                done[I] = true;
+                // hanging nodes are not unknowns of the condensed system
+                if(fine_space.isConstrained(I))
+                    continue;
+                Point<2, X> x_hat = coarse_space.map(p).evaluateInverse(
+                        fine_space.node(I).point());
+                coarse_space.evaluateLagrangeBasis(Nc, x_hat.x(), lx);
+                coarse_space.evaluateLagrangeBasis(Nc, x_hat.y(), ly);
+                for(int kc=0; kc<=Nc; ++kc)
+                {
+                    if(ly[kc]==0.)
+                        continue;
+                    for(int jc=0; jc<=Nc; ++jc)
+                    {
+                        if(lx[jc]==0.)
+                            continue;
+                        addToInterpolation(coarse_space, prolongation[I],
+                                           coarse_space.subDomainIndex(p, jc, kc),
+                                           lx[jc]*ly[kc]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::computeCoarseMatrix(
+        Matrix<X> const &A,
+        std::vector<Interpolation> const &prolongation,
+        int const &coarse_size,
+        Matrix<X> &coarse_matrix)
+{
+    int n = A.rows();
+    // A*P, then P'*(A*P)
+    Matrix<X> AP(n, coarse_size, 0.);
+    for(int r=0; r<n; ++r)
+    {
+        X const *row = A[r];
+        X *product = AP[r];
+        for(int s=0; s<n; ++s)
+        {
+            if(row[s]==X(0))
+                continue;
+            Interpolation const &interpolation = prolongation[s];
+            for(unsigned q=0; q<interpolation.size(); ++q)
+                product[interpolation[q].first] += row[s]*interpolation[q].second;
+        }
+    }
+    coarse_matrix = Matrix<X>(coarse_size, coarse_size, 0.);
+    for(int r=0; r<n; ++r)
+    {
+        X const *product = AP[r];
+        Interpolation const &interpolation = prolongation[r];
+        for(unsigned q=0; q<interpolation.size(); ++q)
+        {
+            X *row = coarse_matrix[interpolation[q].first];
+            X weight = interpolation[q].second;
+            for(int c=0; c<coarse_size; ++c)
+                row[c] += weight*product[c];
+        }
+    }
+    // hanging coarse nodes get no contribution, keep them out of the system
+    for(int c=0; c<coarse_size; ++c)
+        if(coarse_matrix[c][c]==X(0))
+            coarse_matrix[c][c] = 1.;
+};
+
+template<class X>
+bool SemSolver::Solver::Multigrid<X>::setup(Problem<2, X> const &problem,
+                                            SemSpace<2, X> const &space,
+                                            Matrix<X> const &A,
+                                            int const &smoothing)
+{
+    SemGeometry<2, X> const &geometry = space.geometry();
+    Polygonation<2, X> const &hierarchy = geometry.subDomains();
+    unsigned L = hierarchy.levels();
+    _smoothing = smoothing;
+    _levels.assign(L, Level());
+    _levels[L-1].matrix = A;
+#ifdef SEMDEBUG
+    if(hierarchy.size()!=(unsigned)space.subDomains() || A.rows()!=(int)space.nodes())
+    {
+        qWarning("SemSolver::Solver::Multigrid::setup - ERROR : space does not match it"\
+                 "s geometry or matrix.");
+        return false;
+    }
+#endif
+
+    // spaces of two consecutive levels, from the coarsest one
+    std::vector<int> sizes(L);
+    SemGeometry<2, X> *coarse_geometry = 0;
+    SemSpace<2, X> *coarse_space = 0;
+    for(unsigned l=0; l<L; ++l)
+    {
+        SemGeometry<2, X> *level_geometry = 0;
+        SemSpace<2, X> *level_space = 0;
+        if(l<L-1)
+        {
+            Polygonation<2, X> sub_domains;
+            sub_domains.reserve(hierarchy.levelSize(l));
+            for(unsigned i=0; i<hierarchy.levelSize(l); ++i)
+            {
+                typename Polygonation<2, X>::Element const &element =
+                        hierarchy.levelElement(l, i);
+                std::vector<int> neighbours(element.size());
+                for(int j=0; j<element.size(); ++j)
+                    neighbours[j] = element.neighbour(j);
+                sub_domains.addElement(element.geometry(), neighbours);
+            }
+            level_geometry = new SemGeometry<2, X>();
+            level_geometry->setDomain(geometry.domain());
+            level_geometry->setSubDomains(sub_domains);
+            level_space = new SemSpace<2, X>(*level_geometry, *problem.parameters());
+        }
+        SemSpace<2, X> const &fine_space = level_space ? *level_space : space;
+        sizes[l] = fine_space.nodes();
+        if(coarse_space)
+        {
+            computeProlongation(hierarchy, l, *coarse_space, fine_space,
+                                _levels[l].prolongation);
+            delete coarse_space;
+            delete coarse_geometry;
+        }
+        coarse_space = level_space;
+        coarse_geometry = level_geometry;
+    }
+
+    // Galerkin coarse matrices, from the finest one
+    for(unsigned l=L-1; l>0; --l)
+        computeCoarseMatrix(_levels[l].matrix, _levels[l].prolongation, sizes[l-1],
+                            _levels[l-1].matrix);
+
+    for(unsigned l=1; l<L; ++l)
+    {
+        Matrix<X> const &matrix = _levels[l].matrix;
+        for(int i=0; i<matrix.rows(); ++i)
+        {
+            if(matrix[i][i]==X(0))
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::Solver::Multigrid::setup - ERROR : zero diagonal en"\
+                         "try.");
+#endif
+                return false;
+            }
+        }
+    }
+    return coarse.factorize(Factorization<X>::LU, _levels[0].matrix);
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::smooth(int const &level,
+                                             Vector<X> const &b,
+                                             Vector<X> &x) const
+{
+    Matrix<X> const &A = _levels[level].matrix;
+    int n = A.rows();
+    for(int sweep=0; sweep<_smoothing; ++sweep)
+    {
+        for(int i=0; i<n; ++i)
+        {
+            X const *row = A[i];
+            X sum = b[i];
+            for(int j=0; j<n; ++j)
+                sum -= row[j]*x[j];
+            x[i] += sum/row[i];
+        }
+        for(int i=n-1; i>=0; --i)
+        {
+            X const *row = A[i];
+            X sum = b[i];
+            for(int j=0; j<n; ++j)
+                sum -= row[j]*x[j];
+            x[i] += sum/row[i];
+        }
+    }
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::cycle(int const &level,
+                                            Vector<X> const &b,
+                                            Vector<X> &x) const
+{
+    if(level==0)
+    {
+        coarse.solve(b, x);
+        return;
+    }
+    smooth(level, b, x);
+
+    // restrict residual
+    Matrix<X> const &A = _levels[level].matrix;
+    std::vector<Interpolation> const &prolongation = _levels[level].prolongation;
+    int n = A.rows();
+    int coarse_size = _levels[level-1].matrix.rows();
+    Vector<X> r(coarse_size, 0.);
+    for(int i=0; i<n; ++i)
+    {
+        X const *row = A[i];
+        X residual = b[i];
+        for(int j=0; j<n; ++j)
+            residual -= row[j]*x[j];
+        Interpolation const &interpolation = prolongation[i];
+        for(unsigned q=0; q<interpolation.size(); ++q)
+            r[interpolation[q].first] += interpolation[q].second*residual;
+    }
+
+    // correct with the coarse error
+    Vector<X> e(coarse_size, 0.);
+    cycle(level-1, r, e);
+    for(int i=0; i<n; ++i)
+    {
+        Interpolation const &interpolation = prolongation[i];
+        for(unsigned q=0; q<interpolation.size(); ++q)
+            x[i] += interpolation[q].second*e[interpolation[q].first];
+    }
+
+    smooth(level, b, x);
+};
+
+template<class X>
+bool SemSolver::Solver::Multigrid<X>::solve(Vector<X> const &b,
+                                            Vector<X> &x,
+                                            X const &tolerance,
+                                            int const &max_cycles)
+{
+    int top = levels()-1;
+    Matrix<X> const &A = _levels[top].matrix;
+    int n = A.rows();
+    if(x.rows()!=n)
+        x = Vector<X>(n, 0.);
+    X norm = 0.;
+    for(int i=0; i<n; ++i)
+        norm += b[i]*b[i];
+    norm = std::sqrt(norm);
+    if(norm==X(0))
+        norm = 1.;
+    for(_cycles=0; ; ++_cycles)
+    {
+        X residual = 0.;
+        for(int i=0; i<n; ++i)
+        {
+            X const *row = A[i];
+            X sum = b[i];
+            for(int j=0; j<n; ++j)
+                sum -= row[j]*x[j];
+            residual += sum*sum;
+        }
+        _residual = std::sqrt(residual)/norm;
+        if(_residual<=tolerance)
+            return true;
+        if(_cycles>=max_cycles)
+            return false;
+        cycle(top, b, x);
+    }
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::interpolate(SemSpace<2, X> const &coarse_space,
+                                                  Vector<X> const &coarse_x,
+                                                  SemSpace<2, X> const &fine_space,
+                                                  Vector<X> &fine_x)
+{
+    Polygonation<2, X> const &hierarchy = fine_space.geometry().subDomains();
+    unsigned level = 0;
+    if(fine_space.subDomains()!=coarse_space.subDomains())
+        level = hierarchy.levels()-1;
+    fine_x = Vector<X>(fine_space.nodes(), 0.);
+    // anything else gives a zero guess
+    if(coarse_x.rows()!=(int)coarse_space.nodes()
+       || (level ? hierarchy.levelSize(level-1)
+                 : hierarchy.size())!=(unsigned)coarse_space.subDomains())
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::Solver::Multigrid::interpolate - ERROR : spaces do not mat"\
+                 "ch the hierarchy or the solution.");
+#endif
+        return;
+    }
+    std::vector<Interpolation> prolongation;
+    computeProlongation(hierarchy, level, coarse_space, fine_space, prolongation);
+    for(unsigned i=0; i<prolongation.size(); ++i)
+        for(unsigned q=0; q<prolongation[i].size(); ++q)
+            fine_x[i] += prolongation[i][q].second*coarse_x[prolongation[i][q].first];
+};
+
+template<class X>
+void SemSolver::Solver::Multigrid<X>::precondition(Vector<X> const &r,
+                                                   Vector<X> &z) const
+{
+    z = Vector<X>(r.rows(), 0.);
+    cycle(levels()-1, r, z);
+};
+
+#endif // MULTIGRID_HPP
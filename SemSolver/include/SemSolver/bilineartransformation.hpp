@@ -34,6 +34,7 @@ namespace SemSolver
         X _Px, _Qx, _Rx, _Sx;
         X _Py, _Qy, _Ry, _Sy;
         X _PQ, _PR, _PS, _QR, _QS, _RS;
+        X _iQR;
 
         // tolerance for inverse evaluation
         X _tolerance;
@@ -64,6 +65,12 @@ namespace SemSolver
 
         Point<2,X> evaluateInverse(Point<2,X> const &point) const;
 
+        void evaluateInverse(int const &n,
+                             X const *x,
+                             X const *y,
+                             X *x_hat,
+                             X *y_hat) const;
+
         inline X evaluateJacobianDeterminant(Point<2,X> const &point) const;
 
         Matrix<double>
@@ -82,6 +89,7 @@ SemSolver::BilinearTransformation<X>::BilinearTransformation()
     _PQ =  0., _PR =  0.;
     _PS =  0., _QR =  1.;
     _QS =  0., _RS =  0.;
+    _iQR = 1.;
     _tolerance = 0;
 };
 
@@ -111,6 +119,8 @@ SemSolver::BilinearTransformation<X>::BilinearTransformation(Point<2,X> const &A
     _QS = _Qx*_Sy - _Qy*_Sx;
     _RS = _Rx*_Sy - _Ry*_Sx;
 
+    _iQR = 1./_QR;
+
     _tolerance = 0.;
 };
 
@@ -178,6 +188,8 @@ void SemSolver::BilinearTransformation<X>::setOmega(Polygon<2,X> const &omega)
     _QR = _Qx*_Ry - _Qy*_Rx;
     _QS = _Qx*_Sy - _Qy*_Sx;
     _RS = _Rx*_Sy - _Ry*_Sx;
+
+    _iQR = 1./_QR;
 };
 
 /*! \brief Set the tolerance used in evaluating the inverse tranformation               */
@@ -222,49 +234,94 @@ SemSolver::Point<2,X>
 };
 
 //! \brief Evaluate the inverse tranformation at a point
-/*! It uses different algorithms if \f$\Omega\f$ is a parallelogram a trapezoid or a more
-    generic quadrangle.                                                                 */
+/*! It solves \f$\phi(\hat x) = x\f$ with Newton's method, starting from the inverse of
+    the affine part of \f$\phi\f$, which is exact if \f$\Omega\f$ is a parallelogram.
+    Iterations stop when the update is below tolerance.                                 */
 //! \param point The point to be mapped
 template<class X>
 SemSolver::Point<2,X>
         SemSolver::BilinearTransformation<X>::evaluateInverse(
                 Point<2,X> const &point) const
 {
-    X x, y;
-    X XQ = point.x()*_Qy - point.y()*_Qx;
-    X XR = point.x()*_Ry - point.y()*_Rx;
-    X XS = point.x()*_Sy - point.y()*_Sx;
-    if( std::abs(_QS)>_tolerance && std::abs(_RS)>_tolerance )
+    X dx = point.x()-_Px;
+    X dy = point.y()-_Py;
+    X x = (_Rx*dy - _Ry*dx)*_iQR;
+    X y = (_Qy*dx - _Qx*dy)*_iQR;
+    for(int k=0; k<8; ++k)
     {
-        // Omega is not a parallelogram nor a trapezoid
-        X psi = pow(XS-_PS+_QR, 2.) + 2.*(XR*_QS+XQ*_RS-XS*_QR) - \
-                4.*_PQ*_RS;
-        X n0 = XS-_PS;
-        X n1 = _QR - sqrt(psi);
-        X d0 = 2.*_QS;
-        X d1 = 2.*_RS;
-        x = -(n0-n1)/d0;
-        y = -(n0+n1)/d1;
+        // residual and Jacobian of phi(x,y) - point
+        X fx = _Sx*x*y - _Qx*x - _Rx*y - dx;
+        X fy = _Sy*x*y - _Qy*x - _Ry*y - dy;
+        X Jxx = _Sx*y - _Qx, Jxy = _Sx*x - _Rx;
+        X Jyx = _Sy*y - _Qy, Jyy = _Sy*x - _Ry;
+        X iJ = 1./(Jxx*Jyy - Jxy*Jyx);
+        X sx = (Jyy*fx - Jxy*fy)*iJ;
+        X sy = (Jxx*fy - Jyx*fx)*iJ;
+        x -= sx;
+        y -= sy;
+        if(std::abs(sx)<=_tolerance && std::abs(sy)<=_tolerance)
+            break;
     }
-    else if(std::abs(_RS)>_tolerance) // QS trascurabile
-    {
-        // Omega is a vertical trapezoid
-        x = _Qx*(XR-_PR)/(_Sx*(XQ-_PQ)-_Qx*_QR);
-        y = (XQ-_PQ)/_QR;
-    }
-    else if(std::abs(_QS)>_tolerance)
+    return Point<2,X>(x,y);
+};
+
+//! \brief Evaluate the inverse tranformation at many points
+/*! Same algorithm as evaluateInverse(Point), but with a fixed number of Newton
+    iterations and no branches, so that the loop over points can be vectorized by the
+    compiler. Points whose last Newton update is still above tolerance, as may happen
+    on distorted quadrangles, are then mapped again by evaluateInverse(Point), so that
+    results match. Arrays may not overlap.                                              */
+//! \param n Number of points
+//! \param x Abscissae of the points to be mapped
+//! \param y Ordinates of the points to be mapped
+//! \param x_hat Array where to store abscissae of mapped points
+//! \param y_hat Array where to store ordinates of mapped points
+template<class X>
+void SemSolver::BilinearTransformation<X>::evaluateInverse(int const &n,
+                                                           X const *x,
+                                                           X const *y,
+                                                           X *x_hat,
+                                                           X *y_hat) const
+{
+    X const Px = _Px, Py = _Py, Qx = _Qx, Qy = _Qy;
+    X const Rx = _Rx, Ry = _Ry, Sx = _Sx, Sy = _Sy;
+    X const iQR = _iQR;
+    for(int i=0; i<n; ++i)
     {
-        // Omega is a horizontal trapezoid
-        x = (_PR-XR)/_QR;
-        y = _Rx*(_PQ-XQ)/(_Sx*(_PR-XR)-_Rx*_QR);
+        X dx = x[i]-Px;
+        X dy = y[i]-Py;
+        X xi = (Rx*dy - Ry*dx)*iQR;
+        X eta = (Qy*dx - Qx*dy)*iQR;
+        for(int k=0; k<4; ++k)
+        {
+            X fx = Sx*xi*eta - Qx*xi - Rx*eta - dx;
+            X fy = Sy*xi*eta - Qy*xi - Ry*eta - dy;
+            X Jxx = Sx*eta - Qx, Jxy = Sx*xi - Rx;
+            X Jyx = Sy*eta - Qy, Jyy = Sy*xi - Ry;
+            X iJ = 1./(Jxx*Jyy - Jxy*Jyx);
+            xi -= (Jyy*fx - Jxy*fy)*iJ;
+            eta -= (Jxx*fy - Jyx*fx)*iJ;
+        }
+        x_hat[i] = xi;
+        y_hat[i] = eta;
     }
-    else
+    for(int i=0; i<n; ++i)
     {
-        // Omega is a parallelogram
-        x = (_PR-XR)/_QR;
-        y = (XQ-_PQ)/_QR;
+        X xi = x_hat[i], eta = y_hat[i];
+        X fx = Sx*xi*eta - Qx*xi - Rx*eta - (x[i]-Px);
+        X fy = Sy*xi*eta - Qy*xi - Ry*eta - (y[i]-Py);
+        X Jxx = Sx*eta - Qx, Jxy = Sx*xi - Rx;
+        X Jyx = Sy*eta - Qy, Jyy = Sy*xi - Ry;
+        X iJ = 1./(Jxx*Jyy - Jxy*Jyx);
+        X sx = (Jyy*fx - Jxy*fy)*iJ;
+        X sy = (Jxx*fy - Jyx*fx)*iJ;
+        if(!(std::abs(sx)<=_tolerance && std::abs(sy)<=_tolerance))
+        {
+            Point<2,X> const point = evaluateInverse(Point<2,X>(x[i],y[i]));
+            x_hat[i] = point.x();
+            y_hat[i] = point.y();
+        }
     }
-    return Point<2,X>(x,y);
 };
 
 //! \brief Evaluate the Jacobian determinant at a point
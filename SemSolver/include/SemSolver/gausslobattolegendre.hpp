@@ -0,0 +1,78 @@
+#ifndef GAUSSLOBATTOLEGENDRE_HPP
+#define GAUSSLOBATTOLEGENDRE_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//! \brief Project main namespace
+namespace SemSolver
+{
+    //! \brief Evaluate Legendre polynomials of degree N-1 and N at a point
+    /*! Uses the three-term recurrence
+        \f$k L_k(x) = (2k-1) x L_{k-1}(x) - (k-1) L_{k-2}(x)\f$, which is stable for
+        \f$x\in[-1, 1]\f$ and costs O(N) operations                                     */
+    //! \param N Degree, must be positive
+    //! \param x The point where to evaluate polynomials
+    //! \param LN1 Reference where to store \f$L_{N-1}(x)\f$
+    //! \param LN Reference where to store \f$L_N(x)\f$
+    template<class X>
+    void evaluate_legendre(int const &N,
+                           X const &x,
+                           X &LN1,
+                           X &LN)
+    {
+        LN1 = 1.;
+        LN = x;
+        for(int k=2; k<=N; ++k)
+        {
+            X L = ((2.*k-1.)*x*LN - (k-1.)*LN1)/k;
+            LN1 = LN;
+            LN = L;
+        }
+    };
+
+    //! \brief Compute Gauss-Lobatto-Legendre nodes and weights of degree N
+    /*! Nodes are the endpoints of \f$[-1, 1]\f$ and the zeros of \f$L_N'\f$. They are
+        found with Newton's method on \f$(1-x^2)L_N'(x)\f$, written in terms of
+        \f$L_N\f$ and \f$L_{N-1}\f$ so that only the three-term recurrence is needed,
+        starting from Chebyshev-Gauss-Lobatto points. The cost is O(N^2) per iteration
+        and convergence is quadratic, so it is accurate to machine precision for
+        degrees well above 100. Weights are \f$2 / (N(N+1)L_N(x_i)^2)\f$.               */
+    //! \param N Degree, must be positive
+    //! \param nodes Vector where to store the N+1 nodes in increasing order
+    //! \param weights Vector where to store the N+1 weights
+    template<class X>
+    void compute_gll_nodes_and_weights(int const &N,
+                                       std::vector<X> &nodes,
+                                       std::vector<X> &weights)
+    {
+#ifdef SEMDEBUG
+        if(N<1)
+            qFatal("SemSolver::compute_gll_nodes_and_weights - ERROR : degree must be po"\
+                   "sitive.");
+#endif
+        X const pi = std::acos(X(-1.));
+        X const eps = std::numeric_limits<X>::epsilon();
+        nodes.resize(N+1);
+        weights.resize(N+1);
+        for(int i=0; i<=N; ++i)
+        {
+            X x = -std::cos(pi*i/N);
+            X LN1, LN;
+            for(int k=0; k<100; ++k)
+            {
+                evaluate_legendre(N, x, LN1, LN);
+                X dx = (x*LN - LN1)/((N+1.)*LN);
+                x -= dx;
+                if(std::abs(dx)<=eps)
+                    break;
+            }
+            evaluate_legendre(N, x, LN1, LN);
+            nodes[i] = x;
+            weights[i] = 2./(N*(N+1.)*LN*LN);
+        }
+    };
+};
+
+#endif // GAUSSLOBATTOLEGENDRE_HPP
@@ -11,25 +11,57 @@ namespace SemSolver
 {
     //! Class used for stroing the parameters of the spectral element method
     //! It consist of polynomial degree to be used, tolerance and penality coefficient
+    //! and of the order in which subdomains are numbered, and of the target error and
+    //! maximum number of steps of adaptive refinement, of the number of mesh
+    //! smoothing sweeps and of the number of uniform refinements of subdomains
     template <class X>
     class SemParameters
     {
+    public:
+        //! Order of subdomains, and so of the nodes of the space built on them
+        enum Ordering
+        {
+            //! Keep the order of the geometry
+            NATIVE,
+            //! Sort subdomain centroids along a Morton (Z-order) curve
+            MORTON,
+            //! Sort subdomain centroids along a Hilbert curve
+            HILBERT
+        };
+
+    private:
         int _degree;
         X _tolerance;
         X _penality;
+        Ordering _ordering;
+        X _adaptive_tolerance;
+        int _adaptive_steps;
+        int _smoothing_steps;
+        int _refinement_levels;
 
     public:
         //! Default constructor
         SemParameters()
+            : _ordering(NATIVE),
+            _adaptive_tolerance(0.),
+            _adaptive_steps(0),
+            _smoothing_steps(0),
+            _refinement_levels(0)
         {};
 
         //! Construct Parameters from degree, tolerance and penality values
         SemParameters(int const &degree,
                       X const &tolerance,
-                      X const &penality)
+                      X const &penality,
+                      Ordering const &ordering = NATIVE)
                           : _degree(degree),
                           _tolerance(tolerance),
-                          _penality(penality)
+                          _penality(penality),
+                          _ordering(ordering),
+                          _adaptive_tolerance(0.),
+                          _adaptive_steps(0),
+                          _smoothing_steps(0),
+                          _refinement_levels(0)
         {};
 
         //! Access degree parameter
@@ -50,6 +82,38 @@ namespace SemSolver
             return _penality;
         };
 
+        //! Access ordering parameter
+        inline Ordering const &ordering() const
+        {
+            return _ordering;
+        };
+
+        //! Access target error of adaptive refinement
+        inline X const &adaptiveTolerance() const
+        {
+            return _adaptive_tolerance;
+        };
+
+        //! Access maximum number of adaptive refinement steps, 0 if disabled
+        inline int const &adaptiveSteps() const
+        {
+            return _adaptive_steps;
+        };
+
+        //! Access number of mesh smoothing sweeps, 0 if disabled
+        inline int const &smoothingSteps() const
+        {
+            return _smoothing_steps;
+        };
+
+        //! Access number of uniform refinements of subdomains before solving
+        /*! Each refinement adds a level to the hierarchy of subdomains, see
+            Solver::Multigrid */
+        inline int const &refinementLevels() const
+        {
+            return _refinement_levels;
+        };
+
         //! Set degree parameter
         inline void setDegree(const int &d)
         {
@@ -67,6 +131,31 @@ namespace SemSolver
         {
             _penality = p;
         };
+
+        //! Set ordering parameter
+        inline void setOrdering(const Ordering &o)
+        {
+            _ordering = o;
+        };
+
+        //! Set target error and maximum number of steps of adaptive refinement
+        inline void setAdaptivity(const X &t, const int &s)
+        {
+            _adaptive_tolerance = t;
+            _adaptive_steps = s;
+        };
+
+        //! Set number of mesh smoothing sweeps
+        inline void setSmoothing(const int &s)
+        {
+            _smoothing_steps = s;
+        };
+
+        //! Set number of uniform refinements of subdomains before solving
+        inline void setRefinement(const int &l)
+        {
+            _refinement_levels = l;
+        };
     };
 };
 
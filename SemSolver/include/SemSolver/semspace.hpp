@@ -10,6 +10,15 @@ namespace SemSolver
 #include <vector>
 #include <cmath>
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <SemSolver/gausslobattolegendre.hpp>
 #include <SemSolver/hilbertspace.hpp>
 #include <SemSolver/semfunction.hpp>
 #include <SemSolver/multiindex.hpp>
@@ -143,6 +152,90 @@ namespace SemSolver
             std::vector<X> _coefficients;
             std::vector< SemFunction<2,X> *> _base;
 
+            //! Range of points to be located, or of located points on one subdomain
+            struct Range
+            {
+                int element;
+                unsigned first;
+                unsigned last;
+            };
+
+            //! Locate a range of points walking through subdomains neighbours
+            struct Locate
+            {
+                typedef void result_type;
+
+                Polygonation<2,X> const *polygonation;
+                std::vector< Point<2,X> > const *points;
+                std::vector<int> *located;
+
+                void operator()(Range const &range) const
+                {
+                    int hint = -1;
+                    for(unsigned p=range.first; p<range.last; ++p)
+                    {
+                        int i = polygonation->elementIndexAt((*points)[p], hint);
+                        (*located)[p] = i;
+                        if(i>=0)
+                            hint = i;
+                    }
+                };
+            };
+
+            //! Evaluate all points lying on one subdomain
+            struct EvaluateGroup
+            {
+                typedef void result_type;
+
+                Element const *function;
+                std::vector< Point<2,X> > const *points;
+                std::vector<unsigned> const *order;
+                std::vector<X> *values;
+
+                void operator()(Range const &range) const
+                {
+                    SemSpace const *space = function->_space;
+                    int N = space->degree(range.element);
+                    BilinearTransformation<X> const &map = space->map(range.element);
+
+                    // gather subdomain coefficients once for the whole group
+                    std::vector<X> u((N+1)*(N+1));
+                    for(int k=0; k<=N; ++k)
+                        for(int j=0; j<=N; ++j)
+                            u[k*(N+1)+j] = function->_coefficients[
+                                    space->subDomainIndex(range.element, j, k)];
+
+                    // map the whole group onto the canonical element at once
+                    int count = range.last-range.first;
+                    std::vector<X> x(count), y(count), x_hat(count), y_hat(count);
+                    for(int q=0; q<count; ++q)
+                    {
+                        Point<2,X> const &point = (*points)[(*order)[range.first+q]];
+                        x[q] = point.x();
+                        y[q] = point.y();
+                    }
+                    map.evaluateInverse(count, &x[0], &y[0], &x_hat[0], &y_hat[0]);
+
+                    std::vector<X> lx, ly;
+                    for(int q=0; q<count; ++q)
+                    {
+                        unsigned p = (*order)[range.first+q];
+                        space->evaluateLagrangeBasis(N, x_hat[q], lx);
+                        space->evaluateLagrangeBasis(N, y_hat[q], ly);
+                        X result = 0.;
+                        for(int k=0; k<=N; ++k)
+                        {
+                            X row = 0.;
+                            X const *u_k = &u[k*(N+1)];
+                            for(int j=0; j<=N; ++j)
+                                row += u_k[j]*lx[j];
+                            result += row*ly[k];
+                        }
+                        (*values)[p] = result;
+                    }
+                };
+            };
+
         public:
             //! Construct space element from Fourier coefficients
             Element(SemSpace const *space, Vector<X> const &coefficients)
@@ -156,17 +249,90 @@ namespace SemSolver
             ~Element() {};
 
             //! Compute element value at a point
+            /*! The point is located and mapped onto the canonical element once, then
+                only the (N+1)^2 coefficients of that subdomain of degree N are combined */
             X evaluate(Point<2,X> const &x) const
             {
-                double result=0;
-                if(_space->_geometry.contains(x))
+                int i = _space->_geometry.subDomains().elementIndexAt(x);
+                if(i<0)
+                    return 0.;
+                return _space->evaluateRestriction(_coefficients, i,
+                                                   _space->map(i).evaluateInverse(x));
+            };
+
+            //! Compute element values at many points
+            /*! Points are located in parallel, grouped by subdomain and each group is
+                evaluated on the global thread pool. Points outside the domain get 0 */
+            //! \param points The points where to evaluate element
+            //! \param values Vector where to store values in the same order as points
+            void evaluateBatch(std::vector< Point<2,X> > const &points,
+                               std::vector<X> &values) const
+            {
+                Polygonation<2,X> const &polygonation = _space->_geometry.subDomains();
+                unsigned n = points.size();
+                int M = polygonation.size();
+                values.assign(n, 0.);
+                if(!n || !M)
+                    return;
+                polygonation.buildIndex();
+
+                // locate points
+                std::vector<int> located(n);
+                {
+                    unsigned chunks = 4*QThread::idealThreadCount();
+                    if(chunks<1)
+                        chunks = 1;
+                    unsigned chunk_size = (n+chunks-1)/chunks;
+                    QVector<Range> ranges;
+                    for(unsigned begin=0; begin<n; begin+=chunk_size)
+                    {
+                        Range range = { -1, begin, std::min(begin+chunk_size, n) };
+                        ranges.push_back(range);
+                    }
+                    Locate locate;
+                    locate.polygonation = &polygonation;
+                    locate.points = &points;
+                    locate.located = &located;
+                    QtConcurrent::blockingMap(ranges, locate);
+                }
+
+                // sort points by subdomain (counting sort, stable in input order)
+                std::vector<unsigned> first(M+1, 0);
+                for(unsigned p=0; p<n; ++p)
+                    if(located[p]>=0)
+                        ++first[located[p]+1];
+                for(int i=0; i<M; ++i)
+                    first[i+1] += first[i];
+                std::vector<unsigned> order(first[M]);
                 {
-                    for(unsigned i=0; i<_space->nodes(); ++i)
+                    std::vector<unsigned> fill(first.begin(), first.end()-1);
+                    for(unsigned p=0; p<n; ++p)
+                        if(located[p]>=0)
+                            order[fill[located[p]]++] = p;
+                }
+
+                // evaluate groups
+                QVector<Range> groups;
+                for(int i=0; i<M; ++i)
+                {
+                    if(first[i]<first[i+1])
                     {
-                        result += _coefficients[i]*_space->baseFunction(i)->evaluate(x);
+                        Range group = { i, first[i], first[i+1] };
+                        groups.push_back(group);
                     }
                 }
-                return result;
+                EvaluateGroup evaluate_group;
+                evaluate_group.function = this;
+                evaluate_group.points = &points;
+                evaluate_group.order = &order;
+                evaluate_group.values = &values;
+                QtConcurrent::blockingMap(groups, evaluate_group);
+            };
+
+            //! Access Fourier coefficients
+            inline std::vector<X> const &coefficients() const
+            {
+                return _coefficients;
             };
         };
 
@@ -183,6 +349,10 @@ namespace SemSolver
         typedef std::vector<int> BordersVector;
         typedef std::map< MultiIndex<3>, double, Index3Order > WeightsMap;
         typedef typename Polygonation<2,X>::Element SubDomain;
+        //! Coefficients of a hanging node value as pairs of node index and weight
+        typedef std::vector< std::pair<int, X> > Constraint;
+        typedef std::map<int, Constraint> ConstraintsMap;
+        typedef typename ConstraintsMap::const_iterator ConstraintConstIterator;
 
     protected:
 
@@ -193,12 +363,22 @@ namespace SemSolver
         NodesVector _nodes;
         SemFunctionsVector _base;
 
+        std::vector<int> _degrees;
+        std::vector< std::vector<X> > _gll_nodes;
+        std::vector< std::vector<X> > _barycentric_weights;
+        std::vector< std::vector<X> > _derivatives;
+        std::vector< BilinearTransformation<X> > _maps;
+        std::vector<int> _local_nodes;
+        std::vector<int> _local_first;
+
         NodesMap _point_map;
         ElementsMap _element_map;
         BordersMap _border_map;
         std::map<int, int> _border_ids;
         BordersVector _borders;
+        BordersVector _border_elements;
         WeightsMap _weights;
+        ConstraintsMap _constraints;
 
         //! Add index-th subdomain node to space
         inline int addSubDomainNode(MultiIndex<3> const &index,
@@ -217,6 +397,9 @@ namespace SemSolver
             _nodes[i].addSubDomainIndex(index);
 
             _element_map[index] = i;
+            int N = degree(index.subIndex(0));
+            _local_nodes[_local_first[index.subIndex(0)] + index.subIndex(2)*(N+1)
+                         + index.subIndex(1)] = i;
             return i;
         };
 
@@ -240,6 +423,196 @@ namespace SemSolver
             _weights[index] = weight;
         };
 
+        //! Get local indices (j, k) of the m-th node of an edge of a subdomain of degree N
+        /*! Nodes are numbered from vertex e-1 to vertex e of edge e, as the neighbour
+            ids of Polygonation elements */
+        inline void edgeNodeIndices(int const &N,
+                                    int const &e,
+                                    int const &m,
+                                    int &j,
+                                    int &k) const
+        {
+            switch(e)
+            {
+            case 0: // left
+                j = 0;
+                k = N-m;
+                break;
+            case 1: // bottom
+                j = m;
+                k = 0;
+                break;
+            case 2: // right
+                j = N;
+                k = m;
+                break;
+            default: // top
+                j = N-m;
+                k = N;
+                break;
+            }
+        };
+
+        //! Add coefficient of a node to a constraint, merging repeated nodes
+        static void addToConstraint(Constraint &constraint,
+                                    int const &index,
+                                    X const &coefficient)
+        {
+            for(unsigned q=0; q<constraint.size(); ++q)
+            {
+                if(constraint[q].first==index)
+                {
+                    constraint[q].second += coefficient;
+                    return;
+                }
+            }
+            constraint.push_back(std::make_pair(index, coefficient));
+        };
+
+        //! Constrain nodes on edges that face only half of the edge of a neighbour, or
+        //! a whole edge of lower degree
+        /*! Such nodes, except the ones shared with the neighbour, hang on the edge of the
+            neighbour and their values are interpolated from the nodes of the neighbour on
+            it, so that space elements are continuous. The lower degree wins (minimum
+            rule): on conforming edges the higher degree side follows the other one, and
+            an edge faced by two halves of lower degree is restricted to the lowest
+            degree of them, its values being interpolated from some of its nodes. A node
+            may hang on a constrained edge itself, so constraints are substituted into
+            each other until they only refer to free nodes */
+        void addHangingNodeConstraints()
+        {
+            Polygonation<2,X> const &polygonation = _geometry.subDomains();
+            std::vector<X> l;
+            int j, k;
+
+            // lowest degree of the halves facing each split edge
+            std::map<std::pair<int, int>, int> split_degrees;
+            for(int i=0; i<subDomains(); ++i)
+            {
+                for(int e=0; e<4; ++e)
+                {
+                    bool half;
+                    int t = polygonation.facingEdge(i, e, half);
+                    if(t<0 || !half)
+                        continue;
+                    std::pair<int, int> edge(polygonation.element(i).neighbour(e)-1, t);
+                    std::map<std::pair<int, int>, int>::iterator it = split_degrees.find(edge);
+                    if(it==split_degrees.end())
+                        split_degrees[edge] = degree(i);
+                    else
+                        it->second = std::min(it->second, degree(i));
+                }
+            }
+            for(std::map<std::pair<int, int>, int>::const_iterator it = split_degrees.begin();
+            it != split_degrees.end(); ++it)
+            {
+                int c = it->first.first, t = it->first.second;
+                int Nc = degree(c), M = it->second;
+                if(M>=Nc)
+                    continue;
+                SubDomain const &coarse = polygonation.element(c);
+                Point<2,X> const a = coarse.vertex((t+3)%4);
+                Point<2,X> const b = coarse.vertex(t);
+                X length2 = CGAL::squared_distance(a, b);
+                // M+1 nodes spread along the edge, ends included, carry its values
+                std::vector<int> masters(M+1);
+                std::vector<X> xis(M+1);
+                for(int q=0; q<=M; ++q)
+                {
+                    edgeNodeIndices(Nc, t, (q*Nc+M/2)/M, j, k);
+                    masters[q] = subDomainIndex(c, j, k);
+                    xis[q] = 2.*((_nodes[masters[q]].point()-a)*(b-a))/length2 - 1.;
+                }
+                for(int m=1; m<Nc; ++m)
+                {
+                    edgeNodeIndices(Nc, t, m, j, k);
+                    int index = subDomainIndex(c, j, k);
+                    if(_constraints.count(index)
+                       || std::find(masters.begin(), masters.end(), index)!=masters.end())
+                        continue;
+                    X xi = 2.*((_nodes[index].point()-a)*(b-a))/length2 - 1.;
+                    Constraint &constraint = _constraints[index];
+                    for(int q=0; q<=M; ++q)
+                    {
+                        X lq = 1.;
+                        for(int r=0; r<=M; ++r)
+                            if(r!=q)
+                                lq *= (xi-xis[r])/(xis[q]-xis[r]);
+                        addToConstraint(constraint, masters[q], lq);
+                    }
+                }
+            }
+
+            for(int i=0; i<subDomains(); ++i)
+            {
+                int N = degree(i);
+                for(int e=0; e<4; ++e)
+                {
+                    bool half;
+                    int t = polygonation.facingEdge(i, e, half);
+                    if(t<0)
+                        continue;
+                    int c = polygonation.element(i).neighbour(e)-1;
+                    int Nc = degree(c);
+                    if(!half && Nc>=N)
+                        continue;
+                    SubDomain const &coarse = polygonation.element(c);
+                    Point<2,X> const a = coarse.vertex((t+3)%4);
+                    Point<2,X> const b = coarse.vertex(t);
+                    X length2 = CGAL::squared_distance(a, b);
+                    for(int m=0; m<=N; ++m)
+                    {
+                        edgeNodeIndices(N, e, m, j, k);
+                        int index = subDomainIndex(i, j, k);
+                        if(_constraints.count(index))
+                            continue;
+                        Node const &hanging = _nodes[index];
+                        bool shared = false;
+                        for(int s=0; s<hanging.supportSubDomains() && !shared; ++s)
+                            shared = hanging.subDomainIndex(s).subIndex(0)==c;
+                        if(shared)
+                            continue;
+                        // position of the node on the canonical interval of the edge
+                        X xi = 2.*((hanging.point()-a)*(b-a))/length2 - 1.;
+                        evaluateLagrangeBasis(Nc, xi, l);
+                        Constraint &constraint = _constraints[index];
+                        for(int q=0; q<=Nc; ++q)
+                        {
+                            if(l[q]==0.)
+                                continue;
+                            edgeNodeIndices(Nc, t, q, j, k);
+                            addToConstraint(constraint, subDomainIndex(c, j, k), l[q]);
+                        }
+                    }
+                }
+            }
+            bool changed = !_constraints.empty();
+            while(changed)
+            {
+                changed = false;
+                for(typename ConstraintsMap::iterator it = _constraints.begin();
+                it != _constraints.end(); ++it)
+                {
+                    Constraint resolved;
+                    for(unsigned q=0; q<it->second.size(); ++q)
+                    {
+                        ConstraintConstIterator master = _constraints.find(it->second[q].first);
+                        if(master==_constraints.end())
+                        {
+                            addToConstraint(resolved, it->second[q].first,
+                                            it->second[q].second);
+                            continue;
+                        }
+                        changed = true;
+                        for(unsigned r=0; r<master->second.size(); ++r)
+                            addToConstraint(resolved, master->second[r].first,
+                                            it->second[q].second*master->second[r].second);
+                    }
+                    it->second.swap(resolved);
+                }
+            }
+        };
+
         inline int setBaseRestrictionPolynomialFunciton(int const &index,
                                                         int const &element_index,
                                                         Polynomial<X> const &px,
@@ -250,103 +623,156 @@ namespace SemSolver
             return index;
         };
 
-    public:
-
-        //! Construct SpectralElement Spece on Spectral Element Geometry and Parameters
-        SemSpace(SemGeometry<2,X> const &geometry,
-                 SemParameters<X> const &parameters)
-                     : _parameters(parameters),
-                     _geometry(geometry),
-                     _point_map(parameters.tolerance())
+        //! Build space nodes, weights and base functions, see constructors
+        void build(std::vector<int> const &degrees)
         {
-            int N = parameters.degree();
             int M = subDomains();
+            _degrees = degrees;
+            if((int)_degrees.size()!=M)
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::SemSpace::SemSpace - WARNING : degrees do not match "\
+                         "subdomains, using degree parameter.");
+#endif
+                _degrees.assign(M, _parameters.degree());
+            }
+            int max_degree = _parameters.degree();
+            _local_first.assign(M+1, 0);
+            for(int i=0; i<M; ++i)
+            {
+                if(_degrees[i]<1)
+                    _degrees[i] = _parameters.degree();
+                max_degree = std::max(max_degree, _degrees[i]);
+                _local_first[i+1] = _local_first[i] + (_degrees[i]+1)*(_degrees[i]+1);
+            }
+            _local_nodes.assign(_local_first[M], -1);
 
-            // compute legendre polynomials
+            std::vector<bool> used(max_degree+1, false);
+            used[_parameters.degree()] = true;
+            for(int i=0; i<M; ++i)
+                used[_degrees[i]] = true;
+
+            std::vector< std::vector<double> > gll_nodes_of(max_degree+1);
+            std::vector< std::vector<double> > gll_weights_of(max_degree+1);
+            std::vector< std::vector< Polynomial<X> > > gll_poly_of(max_degree+1);
+            _gll_nodes.assign(max_degree+1, std::vector<X>());
+            _barycentric_weights.assign(max_degree+1, std::vector<X>());
+            _derivatives.assign(max_degree+1, std::vector<X>());
 
-            Polynomial<X> _1; // _legendre_0
-            Polynomial<X> _x; // _legendre_1
-            Polynomial<X> LN;
-            Polynomial<X> DLN;
+            for(int N=1; N<=max_degree; ++N)
             {
-                _1.setDegree(0);
-                _1.setCoefficient(0,1.);
-                _x.setDegree(1);
-                _x.setCoefficient(0,0.);
-                _x.setCoefficient(1,1.);
-
-                Polynomial<X> _legendre_k1 = _1;
-                Polynomial<X> _legendre_k2 = _x;
-                Polynomial<X> t1, t2;
-                for (int k=1; k<N; ++k)
-                {
-                    t1 = _x * _legendre_k2;
-                    t1 *= (2.*k+1.)/(k+1.);
-                    t2 = _legendre_k1;
-                    t2 *= k/(k+1.);
-                    _legendre_k1 = _legendre_k2;
-                    _legendre_k2 = t1-t2;
-                }
-                LN = _legendre_k2;
-                DLN = LN.derivative();
-            }
+                if(!used[N])
+                    continue;
 
-            // compute GLL nodes
+                // compute legendre polynomials
 
-            std::vector<double> gll_nodes = DLN.zeros();
-            gll_nodes.push_back(-1.);
-            gll_nodes.push_back(1.);
-            std::sort(gll_nodes.begin(), gll_nodes.end());
+                Polynomial<X> _1; // _legendre_0
+                Polynomial<X> _x; // _legendre_1
+                Polynomial<X> LN;
+                Polynomial<X> DLN;
+                {
+                    _1.setDegree(0);
+                    _1.setCoefficient(0,1.);
+                    _x.setDegree(1);
+                    _x.setCoefficient(0,0.);
+                    _x.setCoefficient(1,1.);
+
+                    Polynomial<X> _legendre_k1 = _1;
+                    Polynomial<X> _legendre_k2 = _x;
+                    Polynomial<X> t1, t2;
+                    for (int k=1; k<N; ++k)
+                    {
+                        t1 = _x * _legendre_k2;
+                        t1 *= (2.*k+1.)/(k+1.);
+                        t2 = _legendre_k1;
+                        t2 *= k/(k+1.);
+                        _legendre_k1 = _legendre_k2;
+                        _legendre_k2 = t1-t2;
+                    }
+                    LN = _legendre_k2;
+                    DLN = LN.derivative();
+                }
 
-            // compute GLL polynomials
+                // compute GLL nodes and weights
 
-            std::vector< Polynomial<X> > gll_poly(N+1);
-            {
-                // i = 0
-                gll_poly[0] = _1-_x; // (1-x^2) / (x-x_i)
-                gll_poly[0] *= DLN; // [ (1-x^2) * DLN(x) ] / (x-x_i)
-                gll_poly[0] /= -N*(N+1)*LN(-1.); // (-1) / [ N*(N+1) ] * [ (1-x^2)
-                // * DLN(x) ] / [ (x-x_i) * LN(x_i) ]
-
-                // 0 < i < N
-                for (int i=1; i<N; ++i)
-                {
-                    gll_poly[i] = DLN.ruffini(gll_nodes[i]); // DLN(x) / (x-x_i)
-                    gll_poly[i] *= _1-_x*_x; // [ (1-x^2) * DLN(x) ] / (x-x_i)
-                    gll_poly[i] /= -N*(N+1)*LN(gll_nodes[i]); // (-1) / [ N*(N+1) ]
-                    // * [ (1-x^2) * DLN(x) ]
-                    // / [ (x-x_i) * LN(x_i) ]
-                }
-
-                // i = N
-                gll_poly[N] = _1+_x; // (-1) * (1-x^2) / (x-x_i)
-                gll_poly[N] *= DLN; // (-1) * [ (1-x^2) * DLN(x) ] / (x-x_i)
-                gll_poly[N] /= N*(N+1)*LN(1.); // (-1) / [ N*(N+1) ] * [ (1-x^2)
-                // * DLN(x) ] / [ (x-x_i) * LN(x_i) ]
-            }
+                std::vector<double> &gll_nodes = gll_nodes_of[N];
+                compute_gll_nodes_and_weights(N, gll_nodes, gll_weights_of[N]);
 
-            // compute GLL weights
+                // barycentric weights of Lagrange interpolation on GLL nodes
 
-            std::vector<double> gll_weights(N+1);
-            for( int i=0; i<=N; ++i)
-            {
-                gll_weights[i] =  2./(N*(N+1.));
-                gll_weights[i] /= LN(gll_nodes[i]) * LN(gll_nodes[i]);
+                _gll_nodes[N].assign(gll_nodes.begin(), gll_nodes.end());
+                _barycentric_weights[N].assign(N+1, 1.);
+                for(int j=0; j<=N; ++j)
+                {
+                    for(int k=0; k<=N; ++k)
+                        if(k!=j)
+                            _barycentric_weights[N][j] *= _gll_nodes[N][j]
+                                                          - _gll_nodes[N][k];
+                    _barycentric_weights[N][j] = 1./_barycentric_weights[N][j];
+                }
+
+                // differentiation matrix, D[m][j] being the derivative of the j-th GLL
+                // polynomial at the m-th node. Diagonal entries are minus the sum of the
+                // others, as derivatives of the constant sum of the polynomials vanish
+
+                std::vector<X> &D = _derivatives[N];
+                std::vector<X> const &w = _barycentric_weights[N];
+                D.assign((N+1)*(N+1), 0.);
+                for(int m=0; m<=N; ++m)
+                {
+                    for(int j=0; j<=N; ++j)
+                    {
+                        if(j==m)
+                            continue;
+                        D[m*(N+1)+j] = w[j]/(w[m]*(_gll_nodes[N][m]-_gll_nodes[N][j]));
+                        D[m*(N+1)+m] -= D[m*(N+1)+j];
+                    }
+                }
+
+                // compute GLL polynomials of base functions, in the monomial basis they
+                // lose accuracy past degree 30 or so, so the assembly takes derivatives
+                // from the differentiation matrix instead, see evaluateBaseGradient
+
+                std::vector< Polynomial<X> > &gll_poly = gll_poly_of[N];
+                gll_poly.resize(N+1);
+                {
+                    // i = 0
+                    gll_poly[0] = _1-_x; // (1-x^2) / (x-x_i)
+                    gll_poly[0] *= DLN; // [ (1-x^2) * DLN(x) ] / (x-x_i)
+                    gll_poly[0] /= -N*(N+1)*LN(-1.); // (-1) / [ N*(N+1) ] * [ (1-x^2)
+                    // * DLN(x) ] / [ (x-x_i) * LN(x_i) ]
+
+                    // 0 < i < N
+                    for (int i=1; i<N; ++i)
+                    {
+                        gll_poly[i] = DLN.ruffini(gll_nodes[i]); // DLN(x) / (x-x_i)
+                        gll_poly[i] *= _1-_x*_x; // [ (1-x^2) * DLN(x) ] / (x-x_i)
+                        gll_poly[i] /= -N*(N+1)*LN(gll_nodes[i]); // (-1) / [ N*(N+1) ]
+                        // * [ (1-x^2) * DLN(x) ]
+                        // / [ (x-x_i) * LN(x_i) ]
+                    }
+
+                    // i = N
+                    gll_poly[N] = _1+_x; // (-1) * (1-x^2) / (x-x_i)
+                    gll_poly[N] *= DLN; // (-1) * [ (1-x^2) * DLN(x) ] / (x-x_i)
+                    gll_poly[N] /= N*(N+1)*LN(1.); // (-1) / [ N*(N+1) ] * [ (1-x^2)
+                    // * DLN(x) ] / [ (x-x_i) * LN(x_i) ]
+                }
             }
 
             // compute maps
 
-            std::vector< BilinearTransformation<X> > maps;
+            std::vector< BilinearTransformation<X> > &maps = _maps;
             for(int i=0; i<M; ++i)
             {
-                SubDomain const &element = geometry.subDomains().element(i);
+                SubDomain const &element = _geometry.subDomains().element(i);
                 maps.push_back( BilinearTransformation<X>(element.geometry(),
                                                           _parameters.tolerance()) );
             }
 
             // get borders ids form PSLG
-            for(unsigned i=0; i<geometry.domain().segments(); ++i)
-                _border_ids[i] = geometry.domain().segment(i).number;
+            for(unsigned i=0; i<_geometry.domain().segments(); ++i)
+                _border_ids[i] = _geometry.domain().segment(i).number;
 
             // compute nodes
 
@@ -358,6 +784,10 @@ namespace SemSolver
 
             for(int i=0; i<M; ++i)
             {
+                int N = _degrees[i];
+                std::vector<double> const &gll_nodes = gll_nodes_of[N];
+                std::vector<double> const &gll_weights = gll_weights_of[N];
+
                 int left = _geometry.subDomains().element(i).neighbour(0);
                 int bottom = _geometry.subDomains().element(i).neighbour(1);
                 int right = _geometry.subDomains().element(i).neighbour(2);
@@ -365,6 +795,7 @@ namespace SemSolver
                 if(left<0) // left is on boundary
                 {
                     _borders.push_back(-left-1);
+                    _border_elements.push_back(i);
                     left = borders();
                 }
                 else
@@ -372,6 +803,7 @@ namespace SemSolver
                 if(bottom<0) // bottom is on boundary
                 {
                     _borders.push_back(-bottom-1);
+                    _border_elements.push_back(i);
                     bottom = borders();
                 }
                 else
@@ -379,6 +811,7 @@ namespace SemSolver
                 if(right<0) // right is on boundary
                 {
                     _borders.push_back(-right-1);
+                    _border_elements.push_back(i);
                     right = borders();
                 }
                 else
@@ -386,6 +819,7 @@ namespace SemSolver
                 if(top<0) // top is on boundary
                 {
                     _borders.push_back(-top-1);
+                    _border_elements.push_back(i);
                     top = borders();
                 }
                 else
@@ -600,6 +1034,8 @@ namespace SemSolver
 
             for(int i=0; i<M; ++i)
             {
+                int N = _degrees[i];
+                std::vector< Polynomial<X> > const &gll_poly = gll_poly_of[N];
                 for(int j=0; j<=N; ++j)
                 {
                     for(int k=0; k<=N; ++k)
@@ -613,7 +1049,45 @@ namespace SemSolver
                     }
                 }
             }
-        }
+
+            // hanging nodes of nonconforming subdomains
+
+            addHangingNodeConstraints();
+        };
+
+    public:
+
+        //! Construct SpectralElement Spece on Spectral Element Geometry and Parameters
+        SemSpace(SemGeometry<2,X> const &geometry,
+                 SemParameters<X> const &parameters)
+                     : _parameters(parameters),
+                     _geometry(geometry),
+                     _point_map(parameters.tolerance())
+        {
+            build(std::vector<int>(subDomains(), parameters.degree()));
+        };
+
+        //! Construct Spectral Element Space with a polynomial degree on each subdomain
+        /*! Space elements are continuous: on an edge between subdomains of different
+            degree, or split on one side, the nodes of the higher degree side are
+            constrained to a trace of the lowest degree, see isConstrained */
+        //! \param degrees Degree of each subdomain, the degree parameter is used if
+        //! their number does not match the subdomains
+        SemSpace(SemGeometry<2,X> const &geometry,
+                 SemParameters<X> const &parameters,
+                 std::vector<int> const &degrees)
+                     : _parameters(parameters),
+                     _geometry(geometry),
+                     _point_map(parameters.tolerance())
+        {
+            build(degrees);
+        };
+
+        //! Get geometry the space is built on
+        inline SemGeometry<2,X> const &geometry() const
+        {
+            return _geometry;
+        };
 
         //! Get number of space nodes
         unsigned nodes() const
@@ -629,6 +1103,45 @@ namespace SemSolver
             return _nodes[index];
         };
 
+        //! Get number of hanging nodes
+        /*! Nodes hang on edges that face only half of the edge of a neighbour, see
+            Polygonation::refineMarked. Their values are not free, but a combination of
+            the values of the nodes of the neighbour on the whole edge */
+        inline unsigned constrainedNodes() const
+        {
+            return _constraints.size();
+        };
+
+        //! Test if index-th node is a hanging node
+        inline bool isConstrained(int const &index) const
+        {
+            return _constraints.count(index)>0;
+        };
+
+        //! Access constraint of index-th node, which must be a hanging node
+        inline Constraint const &constraint(int const &index) const
+        {
+            ConstraintConstIterator it = _constraints.find(index);
+#ifdef SEMDEBUG
+            if(it==_constraints.end())
+                qFatal("SemSolver::SemSpace::constraint - ERROR : node is not constraine"\
+                       "d.");
+#endif
+            return it->second;
+        };
+
+        //! Get iterator to the first hanging node and its constraint
+        inline ConstraintConstIterator constraintsBegin() const
+        {
+            return _constraints.begin();
+        };
+
+        //! Get iterator past the last hanging node and its constraint
+        inline ConstraintConstIterator constraintsEnd() const
+        {
+            return _constraints.end();
+        };
+
         //! Get number of subdomains
         inline int subDomains() const
         {
@@ -648,6 +1161,127 @@ namespace SemSolver
             return it->second;
         }
 
+        //! Get node index of the (j, k)-th node of a subdomain
+        /*! Same as subDomainIndex(MultiIndex<3>) with index = (element, j, k), but with
+            constant time lookup */
+        inline int const &subDomainIndex(int const &element,
+                                         int const &j,
+                                         int const &k) const
+        {
+#ifdef SEMDEBUG
+            if(element<0 || element>=subDomains() || j<0 || j>degree(element) || k<0 ||
+               k>degree(element))
+                qFatal("SemSolver::SemSpace::subDomainIndex - ERROR : index out of range"\
+                       ".");
+#endif
+            return _local_nodes[_local_first[element] + k*(degree(element)+1) + j];
+        };
+
+        //! Access transformation from a subdomain element to canonical element
+        inline BilinearTransformation<X> const &map(int const &element) const
+        {
+#ifdef SEMDEBUG
+            if(element<0 || element>=subDomains())
+                qFatal("SemSolver::SemSpace::map - ERROR : index out of range.");
+#endif
+            return _maps[element];
+        };
+
+        //! Compute the values of 1D GLL Lagrange polynomials of degree N at a point
+        /*! Uses the barycentric formula, so that it costs O(N) operations */
+        //! \param N Degree of one of the subdomains, or degree parameter
+        //! \param x Point of the canonical interval [-1, 1]
+        //! \param values Vector where to store the N+1 values
+        void evaluateLagrangeBasis(int const &N,
+                                   X const &x,
+                                   std::vector<X> &values) const
+        {
+            std::vector<X> const &nodes = _gll_nodes[N];
+            std::vector<X> const &weights = _barycentric_weights[N];
+            values.resize(N+1);
+            X sum = 0.;
+            for(int j=0; j<=N; ++j)
+            {
+                X difference = x-nodes[j];
+                if(difference==0.)
+                {
+                    values.assign(N+1, 0.);
+                    values[j] = 1.;
+                    return;
+                }
+                values[j] = weights[j]/difference;
+                sum += values[j];
+            }
+            for(int j=0; j<=N; ++j)
+                values[j] /= sum;
+        };
+
+        //! Compute the gradient of a base function restricted to a subdomain at a node
+        /*! Derivatives of the GLL Lagrange polynomials at the GLL nodes are read from the
+            differentiation matrix, built from the barycentric weights, so that they are
+            accurate at high degree and most of them vanish */
+        //! \param index Index of the base function, i.e. of its node
+        //! \param element Index of the subdomain
+        //! \param j First local index of the subdomain node
+        //! \param k Second local index of the subdomain node
+        Vector<X> evaluateBaseGradient(int const &index,
+                                       int const &element,
+                                       int const &j,
+                                       int const &k) const
+        {
+            Vector<X> gradient(2, 0.);
+            Node const &node = _nodes[index];
+            int s = 0;
+            while(s<node.supportSubDomains()
+                  && node.subDomainIndex(s).subIndex(0)!=element)
+                ++s;
+            if(s==node.supportSubDomains())
+                return gradient;
+            int j0 = node.subDomainIndex(s).subIndex(1);
+            int k0 = node.subDomainIndex(s).subIndex(2);
+            if(j0!=j && k0!=k)
+                return gradient;
+            int N = degree(element);
+            std::vector<X> const &D = _derivatives[N];
+            X psi_x = k0==k ? D[j*(N+1)+j0] : 0.;
+            X psi_y = j0==j ? D[k*(N+1)+k0] : 0.;
+            Matrix<X> tIJ_phi = map(element).evaluateTransposeInverseJacobian(
+                    Point<2,X>(_gll_nodes[N][j], _gll_nodes[N][k]));
+            gradient[0] = psi_x * tIJ_phi[0][0] + psi_y * tIJ_phi[0][1];
+            gradient[1] = psi_x * tIJ_phi[1][0] + psi_y * tIJ_phi[1][1];
+            return gradient;
+        };
+
+        //! Compute the values of 1D GLL Lagrange polynomials of space degree at a point
+        void evaluateLagrangeBasis(X const &x, std::vector<X> &values) const
+        {
+            evaluateLagrangeBasis(degree(), x, values);
+        };
+
+        //! Compute the value of a space element restricted to a subdomain
+        //! \param coefficients Fourier coefficients of the space element
+        //! \param element Index of the subdomain
+        //! \param x_hat Point of the canonical element
+        X evaluateRestriction(std::vector<X> const &coefficients,
+                              int const &element,
+                              Point<2,X> const &x_hat) const
+        {
+            int N = degree(element);
+            std::vector<X> lx, ly;
+            evaluateLagrangeBasis(N, x_hat.x(), lx);
+            evaluateLagrangeBasis(N, x_hat.y(), ly);
+            int const *local = &_local_nodes[_local_first[element]];
+            X result = 0.;
+            for(int k=0; k<=N; ++k)
+            {
+                X row = 0.;
+                for(int j=0; j<=N; ++j)
+                    row += coefficients[local[k*(N+1)+j]]*lx[j];
+                result += row*ly[k];
+            }
+            return result;
+        };
+
         //! Get node correrponding to an element multindex
         inline Node const &subDomainNode(MultiIndex<3> const &index) const
         {
@@ -679,6 +1313,12 @@ namespace SemSolver
             return _borders[i];
         };
 
+        //! Get degree of the subdomain of i-th border
+        inline int const &borderDegree(int const &i) const
+        {
+            return _degrees[_border_elements[i]];
+        };
+
         //! Get id of border whith index border
         inline int borderId(int const &border) const
         {
@@ -738,10 +1378,33 @@ namespace SemSolver
         };
 
         //! Get space degree
+        /*! It is the degree parameter, subdomains may have a different one, see
+            degree(int) */
         inline int const &degree() const
         {
             return _parameters.degree();
         };
+
+        //! Get degree of a subdomain
+        inline int const &degree(int const &element) const
+        {
+            return _degrees[element];
+        };
+
+        //! Get degrees of all subdomains
+        inline std::vector<int> const &degrees() const
+        {
+            return _degrees;
+        };
+
+        //! Test if all subdomains have the degree parameter
+        bool isUniform() const
+        {
+            for(unsigned i=0; i<_degrees.size(); ++i)
+                if(_degrees[i]!=degree())
+                    return false;
+            return true;
+        };
     };
 }
 
@@ -1,6 +1,44 @@
-function [ x , y , u ] = loadSemSolution( path )
+function [ x , y , u , elements , degree ] = loadSemSolution( path )
 
-values = importdata( path );
-x = values( :, 1 );
-y = values( :, 2 );
-u = values( :, 3 );
\ No newline at end of file
+fid = fopen( path, 'r', 'ieee-le' );
+magic = fread( fid, 8, 'uint8=>char' )';
+if ~strcmp( magic, ['SEMSLN' char(0) char(0)] )
+    % legacy tab-separated solution file
+    fclose( fid );
+    values = importdata( path );
+    x = values( :, 1 );
+    y = values( :, 2 );
+    u = values( :, 3 );
+    elements = [];
+    degree = [];
+    return;
+end
+header = fread( fid, 4, 'uint32' );
+version = header( 1 );
+sizes = fread( fid, 5, 'uint64' );
+n = sizes( 1 );
+M = sizes( 2 );
+fseek( fid, sizes( 3 ), 'bof' );
+x = fread( fid, n, 'double' );
+y = fread( fid, n, 'double' );
+fseek( fid, sizes( 4 ), 'bof' );
+u = fread( fid, n, 'double' );
+fseek( fid, sizes( 5 ), 'bof' );
+if version < 2
+    % one degree for all elements
+    degree = repmat( header( 3 ), M, 1 );
+else
+    % degree of each element, then its node indices
+    degree = fread( fid, M, 'int32' );
+end
+if all( degree == degree( 1 ) )
+    degree = degree( 1 );
+    elements = fread( fid, [ (degree+1)^2, M ], 'int32' )' + 1;
+else
+    % elements of different degrees have different numbers of nodes
+    elements = cell( M, 1 );
+    for e = 1:M
+        elements{ e } = fread( fid, (degree(e)+1)^2, 'int32' )' + 1;
+    end
+end
+fclose( fid );
\ No newline at end of file
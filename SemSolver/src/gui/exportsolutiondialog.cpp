@@ -5,8 +5,26 @@ ExportSolutionDialog::ExportSolutionDialog(QWidget *parent)
 {
     setFileMode(QFileDialog::AnyFile);
     setDefaultSuffix("semsln");
-    setNameFilter("SemSolver Solution (*.semsln)");
+    filters.push_back("SemSolver Solution (*.semsln)");
+    suffixes.push_back("semsln");
+    filters.push_back("VTK Unstructured Grid (*.vtu)");
+    suffixes.push_back("vtu");
+    filters.push_back("VTK Unstructured Grid with Lagrange cells (*.vtu)");
+    suffixes.push_back("vtu");
+    filters.push_back("Legacy VTK (*.vtk)");
+    suffixes.push_back("vtk");
+    filters.push_back("Legacy VTK with Lagrange cells (*.vtk)");
+    suffixes.push_back("vtk");
+    setNameFilters(filters);
     setWindowTitle("Export Solution");
     setAcceptMode(QFileDialog::AcceptSave);
     setConfirmOverwrite(true);
 };
+
+void ExportSolutionDialog::accept()
+{
+    int index = filters.indexOf(selectedNameFilter());
+    if(index>=0)
+        setDefaultSuffix(suffixes.at(index));
+    QFileDialog::accept();
+};
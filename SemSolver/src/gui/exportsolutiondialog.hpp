@@ -3,18 +3,40 @@
 
 #include <QFileDialog>
 #include <QString>
+#include <QStringList>
 #include <QWidget>
 
 class ExportSolutionDialog
     : public QFileDialog
 {
+    QStringList filters;
+    QStringList suffixes;
 public:
+    //! Solution file formats
+    enum Format
+    {
+        SEMSLN,
+        VTU,
+        VTU_LAGRANGE,
+        VTK,
+        VTK_LAGRANGE
+    };
+
     ExportSolutionDialog(QWidget *parent = 0);
+
+    //! Append the suffix of the selected format to file names without one
+    void accept();
+
     inline QString fileName() const
 		{
     return this->selectedFiles()[0];
 };
 
+    inline Format format() const
+		{
+    return Format(filters.indexOf(selectedNameFilter()));
+};
+
 };
 
 #endif // EXPORTSOLUTIONDIALOG_HPP
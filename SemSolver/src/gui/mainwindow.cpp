@@ -1,21 +1,34 @@
 #include "mainwindow.hpp"
 
+#include <QDir>
+#include <QFileInfo>
 #include <QMessageBox>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 #include "../lib/semsolver/matrix.hpp"
 #include "../lib/semsolver/vector.hpp"
 #include "../lib/semsolver/semgeometry.hpp"
 #include "../lib/semsolver/equation.hpp"
 #include "../lib/semsolver/semparameters.hpp"
 #include "../lib/semsolver/semspace.hpp"
+#include "../lib/semsolver-io/solution.hpp"
+#include "../lib/semsolver-io/system.hpp"
+#include "../lib/semsolver-io/vtk.hpp"
 #include "../lib/semsolver-io/workspace.hpp"
+#include "../lib/semsolver-io/workspaceloader.hpp"
 #include "../lib/semsolver-assembler/computealgebraicsystem.hpp"
-#include "../lib/semsolver-solver/choleskysolve.hpp"
-#include "../lib/semsolver-solver/lusolve.hpp"
-#include "../lib/semsolver-solver/qrsolve.hpp"
+#include "../lib/semsolver-assembler/computesystemhash.hpp"
 #include "../lib/semsolver-postprocessor/buildsolution.hpp"
 #include "../lib/semsolver-postprocessor/computesolutionhull.hpp"
 #include "../lib/semsolver-postprocessor/computeplotdata.hpp"
+#include "../lib/semsolver-postprocessor/computeerrorindicators.hpp"
+#include "../lib/semsolver-preprocessor/reorderpolygonation.hpp"
+#include "../lib/semsolver-preprocessor/smoothpolygonation.hpp"
+#include "../lib/semsolver-solver/multigrid.hpp"
 
 #include "newworkspacedialog.hpp"
 #include "openworkspacedialog.hpp"
@@ -61,6 +74,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // variables
     problem = new SemSolver::Problem<2,double>();
+    solution_geometry = 0;
     space = 0;
     solution_function = 0;
     plot_style = 0;
@@ -75,6 +89,8 @@ MainWindow::MainWindow(QWidget *parent)
     // setup connections
     connect(menu_bar->new_workspace, SIGNAL(triggered()), this, SLOT(newWorkspace()));
     connect(menu_bar->open_workspace, SIGNAL(triggered()), this, SLOT(openWorkspace()));
+    connect(menu_bar->compress_workspace, SIGNAL(toggled(bool)), this,
+            SLOT(compressWorkspace(bool)));
     connect(menu_bar->quit, SIGNAL(triggered()), this, SLOT(close()));
 
     connect(menu_bar->new_geometry, SIGNAL(triggered()), this, SLOT(newGeometry()));
@@ -110,6 +126,7 @@ MainWindow::MainWindow(QWidget *parent)
     connect(menu_bar->lu_solve, SIGNAL(triggered()), this, SLOT(solveLU()));
     connect(menu_bar->qr_solve, SIGNAL(triggered()), this, SLOT(solveQR()));
     connect(menu_bar->cholesky_solve, SIGNAL(triggered()), this, SLOT(solveCholesky()));
+    connect(menu_bar->multigrid_solve, SIGNAL(triggered()), this, SLOT(solveMultigrid()));
     connect(menu_bar->export_solution, SIGNAL(triggered()), this, SLOT(exportSolution()));
     connect(menu_bar->change_plot_style, SIGNAL(triggered()), this, SLOT(changePlotStyle()));
     connect(menu_bar->export_plot, SIGNAL(triggered()), this, SLOT(exportPlot()));
@@ -145,6 +162,7 @@ MainWindow::~MainWindow()
     // free variable
     delete problem;
     delete space;
+    delete solution_geometry;
     delete solution_function;
 };
 
@@ -193,6 +211,11 @@ void MainWindow::openWorkspace()
     }
 };
 
+void MainWindow::compressWorkspace(bool compress)
+{
+    SemSolver::IO::set_workspace_compression_level(compress ? 6 : 0);
+};
+
 void MainWindow::newGeometry()
 {
     QMessageBox message(this);
@@ -204,7 +227,7 @@ void MainWindow::newGeometry()
         message.exec();
         return;
     }
-    NewGeometryDialog dialog(this, geometries);
+    NewGeometryDialog dialog(this, geometries, workspace);
     if(!dialog.exec())
         return;
     SemSolver::IO::add_file_to_workspace(workspace, dialog.name()+".semgeo", dialog.file());
@@ -235,7 +258,7 @@ void MainWindow::newGeometryFromPslg()
         message.exec();
         return;
     }
-    NewGeometryFromPslgDialog dialog(this, geometries);
+    NewGeometryFromPslgDialog dialog(this, geometries, workspace);
     if(!dialog.exec())
         return;
     SemSolver::IO::add_file_to_workspace(workspace, dialog.name()+".semgeo", dialog.file());
@@ -808,16 +831,13 @@ bool MainWindow::loadWorkspace(QString const &file)
 {
     delete workspace;
     workspace = new QFile(file);
-    QStringList geometries, equations, boundary_conditions, parameters;
-    if(!SemSolver::IO::get_geometries_list_from_workspace(workspace, geometries))
-        return false;
-    if(!SemSolver::IO::get_equations_list_from_workspace(workspace, equations))
-        return false;
-    if(!SemSolver::IO::get_boundary_conditions_list_from_workspace(workspace,
-                                                                   boundary_conditions))
-        return false;
-    if(!SemSolver::IO::get_parameters_list_from_workspace(workspace, parameters))
+    SemSolver::IO::WorkspaceLoader<double> loader(workspace);
+    if(!loader.open())
         return false;
+    QStringList geometries(loader.geometries());
+    QStringList equations(loader.equations());
+    QStringList boundary_conditions(loader.boundaryConditionsList());
+    QStringList parameters(loader.parametersList());
 
     resetGeometry();
     resetEquation();
@@ -836,43 +856,76 @@ bool MainWindow::loadWorkspace(QString const &file)
     menu_bar->enableBoundaryConditions();
     menu_bar->enableParameters();
 
-    if(!geometries.isEmpty())
-        if(!loadGeometry(geometries[0]))
-            return false;
+    // first component of each kind is loaded, all of them concurrently
+    QString geometry_name = geometries.isEmpty() ? QString() : geometries[0];
+    QString equation_name = equations.isEmpty() ? QString() : equations[0];
+    QString boundary_conditions_name = boundary_conditions.isEmpty() ? QString()
+                                       : boundary_conditions[0];
+    QString parameters_name = parameters.isEmpty() ? QString() : parameters[0];
+    bool ok = loader.load(geometry_name, equation_name, boundary_conditions_name,
+                          parameters_name);
+    loader.close();
+
+    if(loader.geometryLoaded())
+        useGeometry(geometry_name, loader.geometry());
+    if(loader.equationLoaded())
+        useEquation(equation_name, loader.takeEquation());
+    if(loader.boundaryConditionsLoaded())
+        useBoundaryConditions(boundary_conditions_name, loader.boundaryConditions());
+    if(loader.parametersLoaded())
+        useParameters(parameters_name, loader.parameters());
+
+    return ok;
+};
 
-    if(!equations.isEmpty())
-        if(!loadEquation(equations[0]))
-            return false;
+bool MainWindow::loadGeometry(const QString &name)
+{
+    SemSolver::SemGeometry<2,double> geometry;
+    SemSolver::IO::get_geometry_from_workspace(workspace, name, geometry);
+    useGeometry(name, geometry);
+    return true;
+};
 
-    if(!boundary_conditions.isEmpty())
-        if(!loadBoundaryConditions(boundary_conditions[0]))
-            return false;
+bool MainWindow::loadEquation(const QString &name)
+{
+    SemSolver::Equation<2, double> *equation = 0;
+    if(!SemSolver::IO::get_equation_from_workspace(workspace, name, equation))
+        return false;
+    useEquation(name, equation);
+    return true;
+};
 
-    if(!parameters.isEmpty())
-        if(!loadParameters(parameters[0]))
-            return false;
+bool MainWindow::loadBoundaryConditions(const QString &name)
+{
+    SemSolver::BoundaryConditions<2, double> boundary_conditions;
+    SemSolver::IO::get_boundary_conditions_from_workspace(workspace, name,
+                                                          boundary_conditions);
+    useBoundaryConditions(name, boundary_conditions);
+    return true;
+};
 
+bool MainWindow::loadParameters(const QString &name)
+{
+    SemSolver::SemParameters<double> parameters;
+    SemSolver::IO::get_parameters_from_workspace(workspace, name, parameters);
+    useParameters(name, parameters);
     return true;
 };
 
-bool MainWindow::loadGeometry(const QString &name)
+void MainWindow::useGeometry(QString const &name,
+                             SemSolver::SemGeometry<2, double> const &geometry)
 {
-    SemSolver::SemGeometry<2,double> geometry;
-    SemSolver::IO::get_geometry_from_workspace(workspace, name, geometry);
     dock->selectGeometry(name);
     main_frame->plotGeometry(geometry);
     problem->setGeometry(new SemSolver::SemGeometry<2,double>(geometry));
     resetSolution();
     if(problem->isDefined())
         menu_bar->enableSolution();
-    return true;
 };
 
-bool MainWindow::loadEquation(const QString &name)
+void MainWindow::useEquation(QString const &name,
+                             SemSolver::Equation<2, double> *equation)
 {
-    SemSolver::Equation<2, double> *equation = 0;
-    if(!SemSolver::IO::get_equation_from_workspace(workspace, name, equation))
-        return false;
     dock->selectEquation(name);
     main_frame->displayEquation(equation->mml());
 
@@ -880,14 +933,12 @@ bool MainWindow::loadEquation(const QString &name)
     resetSolution();
     if(problem->isDefined())
         menu_bar->enableSolution();
-    return true;
 };
 
-bool MainWindow::loadBoundaryConditions(const QString &name)
+void MainWindow::useBoundaryConditions(
+        QString const &name,
+        SemSolver::BoundaryConditions<2, double> const &boundary_conditions)
 {
-    SemSolver::BoundaryConditions<2, double> boundary_conditions;
-    SemSolver::IO::get_boundary_conditions_from_workspace(workspace, name,
-                                                          boundary_conditions);
     dock->selectBoundaryConditions(name);
     main_frame->setBoundaryConditions(boundary_conditions.labels(),
                                       boundary_conditions.mmls());
@@ -896,20 +947,17 @@ bool MainWindow::loadBoundaryConditions(const QString &name)
     resetSolution();
     if(problem->isDefined())
         menu_bar->enableSolution();
-    return true;
 };
 
-bool MainWindow::loadParameters(const QString &name)
+void MainWindow::useParameters(QString const &name,
+                               SemSolver::SemParameters<double> const &parameters)
 {
-    SemSolver::SemParameters<double> parameters;
-    SemSolver::IO::get_parameters_from_workspace(workspace, name, parameters);
     dock->selectParameters(name);
     main_frame->displayParameters(parameters);
     problem->setParameters(new SemSolver::SemParameters<double>(parameters));
     resetSolution();
     if(problem->isDefined())
         menu_bar->enableSolution();
-    return true;
 };
 
 void MainWindow::resetWorkspace()
@@ -965,71 +1013,185 @@ void MainWindow::resetSolution()
     main_frame->resetSolution();
     menu_bar->disableSolution();
     delete space;
+    delete solution_geometry;
     delete solution_function;
     solution_data.clear();
     solution_poly.clear();
     space = 0;
+    solution_geometry = 0;
     solution_function = 0;
 };
 
 void MainWindow::solveLU()
 {
-    QMessageBox message(this);
-    message.setWindowTitle("Error");
-    message.setText("Problem is singular.");
-
-    qDebug() << "PREPROCESSING";
-    status_bar->showMessage("Pre-processing...");
-    space = new SemSolver::SemSpace<2, double>(*problem->geometry(), *problem->parameters());
-    qDebug() << "ASSEMBLING";
-    status_bar->showMessage("Assembling...");
-    SemSolver::Assembler::compute_algebraic_system(*space, *problem, problem_matrix, problem_vector);
-    qDebug() << "SOLVING";
-    status_bar->showMessage("Solving...");
-    if(!SemSolver::Solver::lu_solve(problem_matrix, problem_vector, solution_vector))
-    {
-        message.exec();
-        return;
-    };
-    qDebug() << "POSTPROCESSING";
-    status_bar->showMessage("Post-processing...");
-    SemSolver::PostProcessor::compute_plot_data(*space, solution_vector, solution_data, solution_poly);
-    SemSolver::PostProcessor::build_solution(*space, solution_vector, solution_function);
-    SemSolver::PostProcessor::compute_solution_hull(*space, solution_vector, xmin, ymin, zmin, xmax, ymax, zmax);
-    qDebug() << "DONE";
-    status_bar->showMessage("Done!");
-    plotSolution();
-    main_frame->setCurrentIndex(1);
-    menu_bar->export_solution->setEnabled(true);
-    menu_bar->change_plot_style->setEnabled(true);
-    menu_bar->export_plot->setEnabled(true);
-    return;
+    solve(SemSolver::Solver::Factorization<double>::LU, "Problem is singular.");
 };
 
 void MainWindow::solveQR()
+{
+    solve(SemSolver::Solver::Factorization<double>::QR, "Problem is not full rank.");
+};
+
+void MainWindow::solveCholesky()
+{
+    solve(SemSolver::Solver::Factorization<double>::CHOLESKY,
+          "Problem is not symmetric, positive definite.");
+};
+
+void MainWindow::solveMultigrid()
+{
+    solve(SemSolver::Solver::Factorization<double>::LU,
+          "Multigrid did not converge, check refinement levels.", true);
+};
+
+void MainWindow::solve(SemSolver::Solver::Factorization<double>::Type const &type,
+                       QString const &error,
+                       bool const &multigrid)
 {
     QMessageBox message(this);
     message.setWindowTitle("Error");
-    message.setText("Problem is not full rank.");
+    message.setText(error);
 
     qDebug() << "PREPROCESSING";
     status_bar->showMessage("Pre-processing...");
-    space = new SemSolver::SemSpace<2, double>(*problem->geometry(), *problem->parameters());
-    qDebug() << "ASSEMBLING";
-    status_bar->showMessage("Assembling...");
-    SemSolver::Assembler::compute_algebraic_system(*space, *problem, problem_matrix, problem_vector);
-    qDebug() << "SOLVING";
-    status_bar->showMessage("Solving...");
-    if(!SemSolver::Solver::qr_solve(problem_matrix, problem_vector, solution_vector))
-    {
-        message.exec();
-        return;
-    };
+    QTime time;
+    time.start();
+    // the previous solution is dropped, as its function refers to the previous space
+    menu_bar->export_solution->setEnabled(false);
+    menu_bar->change_plot_style->setEnabled(false);
+    menu_bar->export_plot->setEnabled(false);
+    delete solution_function;
+    solution_function = 0;
+    solution_vector = SemSolver::Vector<double>();
+    delete space;
+    delete solution_geometry;
+    // subdomains of a copy of the problem geometry are smoothed, refined and renumbered
+    // before the space is built, so that its nodes follow. Smoothing comes first, as
+    // moving vertices of refined subdomains would break nesting of the multigrid levels,
+    // and renumbering keeps the refinement hierarchy
+    solution_geometry = new SemSolver::SemGeometry<2, double>(*problem->geometry());
+    SemSolver::SemParameters<double>::Ordering ordering = problem->parameters()->ordering();
+    int smoothing = problem->parameters()->smoothingSteps();
+    int refinement = problem->parameters()->refinementLevels();
+    if(ordering!=SemSolver::SemParameters<double>::NATIVE || smoothing>0 || refinement>0)
+    {
+        SemSolver::Polygonation<2, double> sub_domains = solution_geometry->subDomains();
+        if(smoothing>0)
+        {
+            std::vector<double> qualities;
+            std::vector<unsigned> histogram;
+            SemSolver::PreProcessor::compute_element_qualities(sub_domains, qualities);
+            SemSolver::PreProcessor::compute_quality_histogram(qualities, 10, histogram);
+            qDebug() << "QUALITY BEFORE SMOOTHING"
+                    << QVector<unsigned>::fromStdVector(histogram);
+            if(!SemSolver::PreProcessor::smooth_polygonation(sub_domains, smoothing))
+                qDebug() << "SMOOTHED MESH HAS NON CONVEX SUBDOMAINS";
+            SemSolver::PreProcessor::compute_element_qualities(sub_domains, qualities);
+            SemSolver::PreProcessor::compute_quality_histogram(qualities, 10, histogram);
+            qDebug() << "QUALITY AFTER SMOOTHING"
+                    << QVector<unsigned>::fromStdVector(histogram);
+        }
+        if(refinement>0)
+            sub_domains.refine(refinement);
+        if(ordering!=SemSolver::SemParameters<double>::NATIVE)
+            SemSolver::PreProcessor::reorder_polygonation(sub_domains, ordering);
+        solution_geometry->setSubDomains(sub_domains);
+    }
+    space = new SemSolver::SemSpace<2, double>(*solution_geometry, *problem->parameters());
+    qDebug() << "PREPROCESSED IN" << time.restart() << "ms";
+
+    // with adaptivity, subdomains with the largest error indicators are refined and
+    // the problem is solved again, until the estimated error is below target. Where
+    // the solution is smooth the degree is raised, elsewhere subdomains are split
+    int steps = problem->parameters()->adaptiveSteps();
+    for(int step=0; ; ++step)
+    {
+        // solutions of byte-identical problems are cached in the workspace
+        QByteArray hash = SemSolver::Assembler::compute_problem_hash(*problem,
+                                                                     space->degrees(),
+                                                                     solution_geometry);
+        bool cached = !hash.isEmpty()
+                      && SemSolver::IO::get_cached_solution_from_workspace(workspace, hash,
+                                                                           *space,
+                                                                           solution_vector);
+        if(!cached)
+        {
+            if(!computeSolution(type, multigrid))
+            {
+                message.exec();
+                return;
+            }
+            if(!hash.isEmpty())
+                SemSolver::IO::add_cached_solution_to_workspace(workspace, hash, *space,
+                                                                solution_vector);
+        }
+        qDebug() << "SOLVED IN" << time.restart() << "ms";
+        if(step>=steps)
+            break;
+
+        std::vector<double> indicators;
+        SemSolver::PostProcessor::compute_error_indicators(*space, solution_vector,
+                                                           indicators);
+        double error = 0.;
+        for(unsigned i=0; i<indicators.size(); ++i)
+            error += indicators[i]*indicators[i];
+        error = std::sqrt(error);
+        qDebug() << "STEP" << step << "NODES" << space->nodes()
+                 << "ESTIMATED ERROR" << error;
+        if(error<=problem->parameters()->adaptiveTolerance())
+            break;
+        status_bar->showMessage("Refining...");
+        std::vector<bool> marked;
+        SemSolver::PostProcessor::compute_refinement_marks(indicators, 0.5, marked);
+        std::vector<double> rates;
+        SemSolver::PostProcessor::compute_decay_rates(*space, solution_vector, rates);
+        std::vector<int> degrees = space->degrees();
+        for(unsigned i=0; i<marked.size(); ++i)
+        {
+            if(marked[i] && rates[i]>1.)
+            {
+                ++degrees[i];
+                marked[i] = false;
+            }
+        }
+        // the refined mesh only belongs to this solution, the problem geometry is kept
+        SemSolver::SemGeometry<2, double> *geometry =
+                new SemSolver::SemGeometry<2, double>(*solution_geometry);
+        SemSolver::Polygonation<2, double> sub_domains = geometry->subDomains();
+        if(std::count(marked.begin(), marked.end(), true))
+        {
+            // split subdomains keep the degree of their parent
+            sub_domains.refineMarked(marked);
+            unsigned level = sub_domains.levels()-1;
+            std::vector<int> parent_degrees;
+            parent_degrees.swap(degrees);
+            for(unsigned i=0; i<sub_domains.size(); ++i)
+                degrees.push_back(parent_degrees[sub_domains.parent(level, i)]);
+        }
+        geometry->setSubDomains(sub_domains);
+        SemSolver::SemSpace<2, double> *refined_space =
+                new SemSolver::SemSpace<2, double>(*geometry, *problem->parameters(),
+                                                   degrees);
+        // multigrid starts again from the previous solution
+        if(multigrid)
+        {
+            SemSolver::Vector<double> guess;
+            SemSolver::Solver::Multigrid<double>::interpolate(*space, solution_vector,
+                                                              *refined_space, guess);
+            solution_vector = guess;
+        }
+        delete space;
+        delete solution_geometry;
+        solution_geometry = geometry;
+        space = refined_space;
+        qDebug() << "REFINED IN" << time.restart() << "ms";
+    }
     qDebug() << "POSTPROCESSING";
     status_bar->showMessage("Post-processing...");
     SemSolver::PostProcessor::compute_plot_data(*space, solution_vector, solution_data, solution_poly);
     SemSolver::PostProcessor::build_solution(*space, solution_vector, solution_function);
     SemSolver::PostProcessor::compute_solution_hull(*space, solution_vector, xmin, ymin, zmin, xmax, ymax, zmax);
+    qDebug() << "POSTPROCESSED IN" << time.elapsed() << "ms";
     qDebug() << "DONE";
     status_bar->showMessage("Done!");
     plotSolution();
@@ -1040,38 +1202,82 @@ void MainWindow::solveQR()
     return;
 };
 
-void MainWindow::solveCholesky()
+bool MainWindow::computeSolution(SemSolver::Solver::Factorization<double>::Type const &type,
+                                 bool const &multigrid)
 {
-    QMessageBox message(this);
-    message.setWindowTitle("Error");
-    message.setText("Problem is not symmetric, positive definite.");
-
-    qDebug() << "PREPROCESSING";
-    status_bar->showMessage("Pre-processing...");
-    space = new SemSolver::SemSpace<2, double>(*problem->geometry(), *problem->parameters());
+    typedef SemSolver::Solver::Factorization<double> Factorization;
+
+    // matrix and factorization are stored beside the workspace, keyed by the inputs
+    // they depend on, so that solving again with other forcing or boundary data only
+    // assembles the constant term
+    QByteArray hash = SemSolver::Assembler::compute_system_hash(*problem,
+                                                                space->degrees(),
+                                                                solution_geometry);
+    QFile system(SemSolver::IO::get_system_file_name(workspace->fileName(), hash));
+    SemSolver::IO::SystemFile system_file(&system);
+    bool stored = !hash.isEmpty() && system.exists() && system_file.open()
+                  && system_file.hash()==hash && system_file.size()==space->nodes();
+    Factorization factorization;
     qDebug() << "ASSEMBLING";
     status_bar->showMessage("Assembling...");
-    SemSolver::Assembler::compute_algebraic_system(*space, *problem, problem_matrix, problem_vector);
+    QTime time;
+    time.start();
+    if(stored && !multigrid && system_file.type()==type)
+    {
+        SemSolver::Assembler::compute_algebraic_vector(*space, *problem, problem_vector);
+        problem_matrix = SemSolver::Matrix<double>();
+        factorization = system_file.factorization();
+    }
+    else
+    {
+        if(stored)
+        {
+            int n = system_file.size();
+            problem_matrix = SemSolver::Matrix<double>(n, n);
+            memcpy(problem_matrix[0], system_file.matrix(), (size_t)n*n*sizeof(double));
+            SemSolver::Assembler::compute_algebraic_vector(*space, *problem, problem_vector);
+        }
+        else
+            SemSolver::Assembler::compute_algebraic_system(*space, *problem, problem_matrix,
+                                                           problem_vector);
+        system_file.close();
+        qDebug() << "ASSEMBLED IN" << time.restart() << "ms";
+        if(multigrid)
+        {
+            // V-cycles on the hierarchy of subdomains, see SemParameters::refinementLevels
+            qDebug() << "MULTIGRID SETUP";
+            status_bar->showMessage("Setting up multigrid...");
+            SemSolver::Solver::Multigrid<double> multigrid_solver;
+            if(!multigrid_solver.setup(*problem, *space, problem_matrix))
+                return false;
+            if(!stored && !hash.isEmpty() && QDir().mkpath(QFileInfo(system).absolutePath()))
+                SemSolver::IO::write_system(&system, hash, problem_matrix, factorization);
+            qDebug() << "SOLVING";
+            status_bar->showMessage("Solving...");
+            bool converged = multigrid_solver.solve(problem_vector, solution_vector,
+                                                    problem->parameters()->tolerance());
+            qDebug() << "MULTIGRID LEVELS" << multigrid_solver.levels()
+                     << "CYCLES" << multigrid_solver.cycles()
+                     << "RESIDUAL" << multigrid_solver.residual();
+            if(!converged)
+                return false;
+            SemSolver::Assembler::distribute_constrained_values(*space, solution_vector);
+            return true;
+        }
+        qDebug() << "FACTORIZING";
+        status_bar->showMessage("Factorizing...");
+        if(!factorization.factorize(type, problem_matrix))
+            return false;
+        if(!hash.isEmpty() && QDir().mkpath(QFileInfo(system).absolutePath()))
+            SemSolver::IO::write_system(&system, hash, problem_matrix, factorization);
+    }
     qDebug() << "SOLVING";
     status_bar->showMessage("Solving...");
-    if(!SemSolver::Solver::cholesky_solve(problem_matrix, problem_vector, solution_vector))
-    {
-        message.exec();
-        return;
-    };
-    qDebug() << "POSTPROCESSING";
-    status_bar->showMessage("Post-processing...");
-    SemSolver::PostProcessor::compute_plot_data(*space, solution_vector, solution_data, solution_poly);
-    SemSolver::PostProcessor::build_solution(*space, solution_vector, solution_function);
-    SemSolver::PostProcessor::compute_solution_hull(*space, solution_vector, xmin, ymin, zmin, xmax, ymax, zmax);
-    qDebug() << "DONE";
-    status_bar->showMessage("Done!");
-    plotSolution();
-    main_frame->setCurrentIndex(1);
-    menu_bar->export_solution->setEnabled(true);
-    menu_bar->change_plot_style->setEnabled(true);
-    menu_bar->export_plot->setEnabled(true);
-    return;
+    if(!factorization.solve(problem_vector, solution_vector))
+        return false;
+    // hanging nodes were condensed out of the system
+    SemSolver::Assembler::distribute_constrained_values(*space, solution_vector);
+    return true;
 };
 
 void MainWindow::exportSolution()
@@ -1091,16 +1297,28 @@ void MainWindow::exportSolution()
             return;
         }
     }
-    if(!file.open(QIODevice::WriteOnly))
+    bool ok = false;
+    switch(dialog.format())
+    {
+    case ExportSolutionDialog::SEMSLN:
+        ok = SemSolver::IO::write_solution(*space, solution_vector, &file);
+        break;
+    case ExportSolutionDialog::VTU:
+    case ExportSolutionDialog::VTU_LAGRANGE:
+        ok = SemSolver::IO::write_vtu(*space, solution_vector, &file,
+                                      dialog.format()==ExportSolutionDialog::VTU_LAGRANGE);
+        break;
+    case ExportSolutionDialog::VTK:
+    case ExportSolutionDialog::VTK_LAGRANGE:
+        ok = SemSolver::IO::write_vtk(*space, solution_vector, &file,
+                                      dialog.format()==ExportSolutionDialog::VTK_LAGRANGE);
+        break;
+    }
+    if(!ok)
     {
         message.exec();
         return;
     }
-    QTextStream out(&file);
-    int n = solution_vector.rows();
-    for(int i=0; i<n; ++i)
-        out << space->node(i).point().x() << "\t" << space->node(i).point().y() << "\t" << solution_vector[i] << "\n" ;
-    file.close();
 };
 
 void MainWindow::changePlotStyle()
@@ -14,6 +14,7 @@
 #include "../lib/semsolver/problem.hpp"
 #include "../lib/semsolver/semspace.hpp"
 #include "../lib/semsolver/vector.hpp"
+#include "../lib/semsolver-solver/factorization.hpp"
 
 #include "dock.hpp"
 #include "mainframe.hpp"
@@ -39,6 +40,9 @@ class MainWindow
 
     //variables
     SemSolver::Problem<2, double> *problem;
+    // geometry the space is built on, the problem one with subdomains reordered,
+    // smoothed or refined, so that the problem geometry is left as the user chose it
+    SemSolver::SemGeometry<2, double> *solution_geometry;
     SemSolver::SemSpace<2, double> *space;
     SemSolver::Matrix<double> problem_matrix;
     SemSolver::Vector<double> problem_vector;
@@ -58,6 +62,15 @@ private:
 
     bool loadWorkspace(QString const &workspace);
 
+    void useGeometry(QString const &name,
+                     SemSolver::SemGeometry<2, double> const &geometry);
+    void useEquation(QString const &name,
+                     SemSolver::Equation<2, double> *equation);
+    void useBoundaryConditions(QString const &name,
+                               SemSolver::BoundaryConditions<2, double> const &bc);
+    void useParameters(QString const &name,
+                       SemSolver::SemParameters<double> const &parameters);
+
     void resetWorkspace();
     void resetGeometry();
     void resetEquation();
@@ -67,10 +80,18 @@ private:
 
     void plotSolution();
 
+    // with multigrid, V-cycles replace the factorization of the given type
+    void solve(SemSolver::Solver::Factorization<double>::Type const &type,
+               QString const &error,
+               bool const &multigrid = false);
+    bool computeSolution(SemSolver::Solver::Factorization<double>::Type const &type,
+                         bool const &multigrid = false);
+
 public slots:
 
     void newWorkspace();
     void openWorkspace();
+    void compressWorkspace(bool compress);
 
     void newGeometry();
     void newGeometryFromPslg();
@@ -100,6 +121,7 @@ public slots:
     void solveLU();
     void solveQR();
     void solveCholesky();
+    void solveMultigrid();
     void exportSolution();
     void changePlotStyle();
     void exportPlot();
@@ -8,6 +8,7 @@ MenuBar::MenuBar(QWidget *parent)
     file = new QMenu("&File", this);
     new_workspace = new QAction("&New Workspace...", file);
     open_workspace = new QAction("&Open Workspace...", file);
+    compress_workspace = new QAction("&Compress Workspace", file);
     quit = new QAction("&Quit",file);
 
     geometry = new QMenu("&Geometry",this);
@@ -52,6 +53,7 @@ MenuBar::MenuBar(QWidget *parent)
     lu_solve = new QAction("Solve with &LU decomposition", solution);
     qr_solve = new QAction("Solve with &QR decomposition", solution);
     cholesky_solve = new QAction("Solve with &Cholesky decomposition", solution);
+    multigrid_solve = new QAction("Solve with &Multigrid", solution);
     export_solution = new QAction("&Export Solution", solution);
     change_plot_style = new QAction("&View solution surface", solution);
     export_plot = new QAction("Export &Plot", solution);
@@ -66,11 +68,16 @@ MenuBar::MenuBar(QWidget *parent)
     file->addAction(new_workspace);
     file->addAction(open_workspace);
     file->addSeparator();
+    file->addAction(compress_workspace);
+    file->addSeparator();
     file->addAction(quit);
     new_workspace->setShortcut(QKeySequence::New);
     new_workspace->setStatusTip("Create a new workspace");
     open_workspace->setShortcut(QKeySequence::Open);
     open_workspace->setStatusTip("Open an existing workspace");
+    compress_workspace->setCheckable(true);
+    compress_workspace->setStatusTip("Store new workspace entries compressed, which "\
+                                     "older versions cannot read");
     quit->setShortcuts(QKeySequence::Quit);
     quit->setStatusTip("Quit the application");
 
@@ -150,6 +157,7 @@ MenuBar::MenuBar(QWidget *parent)
     solution->addAction(lu_solve);
     solution->addAction(qr_solve);
     solution->addAction(cholesky_solve);
+    solution->addAction(multigrid_solve);
     solution->addSeparator();
     solution->addAction(export_solution);
     solution->addSeparator();
@@ -158,6 +166,7 @@ MenuBar::MenuBar(QWidget *parent)
     lu_solve->setStatusTip("Compute solution with LU decomposition");
     qr_solve->setStatusTip("Compute solution with QR decomposition");
     cholesky_solve->setStatusTip("Compute solution with Cholesky decomposition");
+    multigrid_solve->setStatusTip("Compute solution with multigrid V-cycles");
     export_solution->setStatusTip("Export solution to file");
     change_plot_style->setStatusTip("Change plot style");
     export_plot->setStatusTip("Export plot to file");
@@ -180,6 +189,7 @@ MenuBar::~MenuBar()
     // free interface
     delete new_workspace;
     delete open_workspace;
+    delete compress_workspace;
     delete quit;
     delete file;
 
@@ -215,6 +225,7 @@ MenuBar::~MenuBar()
     delete lu_solve;
     delete qr_solve;
     delete cholesky_solve;
+    delete multigrid_solve;
     delete solution;
     delete export_solution;
     delete change_plot_style;
@@ -23,6 +23,7 @@ public:
 
     QAction *new_workspace;
     QAction *open_workspace;
+    QAction *compress_workspace;
     QAction *quit;
 
     QAction *new_geometry;
@@ -53,6 +54,7 @@ public:
     QAction *lu_solve;
     QAction *qr_solve;
     QAction *cholesky_solve;
+    QAction *multigrid_solve;
     QAction *export_solution;
     QAction *change_plot_style;
     QAction *export_plot;
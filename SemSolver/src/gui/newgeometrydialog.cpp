@@ -1,5 +1,6 @@
 #include "newgeometrydialog.hpp"
 
+#include <QBuffer>
 #include <QHeaderView>
 #include <QMessageBox>
 
@@ -7,12 +8,17 @@
 #include "../lib/semsolver-io/pslg.hpp"
 #include "../lib/semsolver-io/subdomains.hpp"
 #include "../lib/semsolver-io/geometry.hpp"
+#include "../lib/semsolver-io/workspace.hpp"
+#include "../lib/semsolver/polygonationcache.hpp"
 #include "../lib/semsolver-preprocessor/computepolygonationfrompslg.hpp"
+#include "../lib/semsolver-preprocessor/computepslghash.hpp"
 
 NewGeometryDialog::NewGeometryDialog(QWidget *parent,
-                                     const QStringList &existing_geometries)
+                                     const QStringList &existing_geometries,
+                                     QFile *workspace_file)
                                          : QDialog(parent),
-                                         geometries(existing_geometries)
+                                         geometries(existing_geometries),
+                                         workspace(workspace_file)
 {
     layout = new QVBoxLayout(this);
     central_widget = new QWidget(this);
@@ -695,17 +701,38 @@ void NewGeometryDialog::saveFile()
         message.exec();
         return;
     }
-    if(!SemSolver::PreProcessor::compute_polygonation_from_pslg(pslg, polygonation))
+    // subdomains of an unchanged PSLG are taken from memory or from the workspace,
+    // in the form they are read back from the geometry
+    QByteArray hash = SemSolver::PreProcessor::compute_pslg_hash(pslg, 0.);
+    SemSolver::PolygonationCache<double> &cache =
+            SemSolver::PolygonationCache<double>::global();
+    if(!cache.find(hash, polygonation))
     {
-        QMessageBox message;
-        message.setText("Error. The PSLG does not describe a valid polygon with holes.");
-        message.exec();
-        return;
+        QByteArray data;
+        if(!SemSolver::IO::get_cached_subdomains_from_workspace(workspace, hash, data))
+        {
+            if(!SemSolver::PreProcessor::compute_polygonation_from_pslg(pslg, polygonation))
+            {
+                QMessageBox message;
+                message.setText("Error. The PSLG does not describe a valid polygon with h"
+                                "oles.");
+                message.exec();
+                return;
+            }
+            if(!polygonation.isQuadrangulation())
+                polygonation.refine();
+            QBuffer buffer;
+            SemSolver::IO::write_subdomains(polygonation, &buffer);
+            data = buffer.data();
+            SemSolver::IO::add_cached_subdomains_to_workspace(workspace, hash, data);
+        }
+        QBuffer buffer;
+        buffer.setData(data);
+        SemSolver::IO::read_subdomains(&buffer, polygonation);
+        cache.insert(hash, polygonation);
     }
-    if(!polygonation.isQuadrangulation())
-        polygonation.refine();
     SemSolver::IO::write_subdomains(polygonation, &temp_subdomains_file);
-    SemSolver::IO::write_geometry(&temp_pslg_file, &temp_subdomains_file, &temp_file);
+    SemSolver::IO::write_geometry(&temp_pslg_file, &temp_subdomains_file, &temp_file, hash);
     done(true);
 };
 
@@ -54,6 +54,7 @@ class NewGeometryDialog : public QDialog
     // variables
     QTemporaryFile temp_file;
     QStringList const &geometries;
+    QFile *workspace;
     SemSolver::PointsBimap<2, double> *vertices_map;
     SemSolver::SegmentsMap<2, double> *segments_map;
     SemSolver::PointsBimap<2, double> *holes_map;
@@ -65,7 +66,8 @@ class NewGeometryDialog : public QDialog
 
 public:
     NewGeometryDialog(QWidget *parent,
-                      QStringList const &existing_geometries);
+                      QStringList const &existing_geometries,
+                      QFile *workspace_file);
     ~NewGeometryDialog();
     inline QTemporaryFile *file()
 		{
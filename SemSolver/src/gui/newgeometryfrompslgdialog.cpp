@@ -1,27 +1,37 @@
 #include "newgeometryfrompslgdialog.hpp"
 
+#include <QBuffer>
+#include <QDoubleValidator>
 #include <QFileDialog>
 #include <QMessageBox>
 
 #include "geometrytolerancedialog.hpp"
 #include "../lib/semsolver/pslg.hpp"
 #include "../lib/semsolver/polygonation.hpp"
+#include "../lib/semsolver/polygonationcache.hpp"
 #include "../lib/semsolver-preprocessor/computepolygonationfrompslg.hpp"
+#include "../lib/semsolver-preprocessor/computepslghash.hpp"
+#include "../lib/semsolver-preprocessor/computequadrangulationfrompslg.hpp"
 /*
 #include "../lib/semsolver-io/subdomains.hpp"
 */
 #include "../lib/semsolver-io/geometry.hpp"
+#include "../lib/semsolver-io/subdomains.hpp"
+#include "../lib/semsolver-io/workspace.hpp"
 
 
 NewGeometryFromPslgDialog::NewGeometryFromPslgDialog(
         QWidget *parent,
-        const QStringList &existing_geometries)
-    : QDialog(parent), geometries(existing_geometries)
+        const QStringList &existing_geometries,
+        QFile *workspace_file)
+    : QDialog(parent), geometries(existing_geometries), workspace(workspace_file)
 {
     layout = new QGridLayout(this);
     label_poly_file = new QLabel(this);
     poly_file_name = new QLabel(this);
     message = new QLabel(this);
+    label_size = new QLabel(this);
+    element_size = new QLineEdit(this);
     button_browse = new QPushButton(this);
     label_name = new QLabel(this);
     file_name = new QLineEdit(this);
@@ -30,6 +40,10 @@ NewGeometryFromPslgDialog::NewGeometryFromPslgDialog(
     label_poly_file->setText("PSLG:");
     poly_file_name->setText("<i>none selected</i>");
     button_browse->setText("&Browse");
+    label_size->setText("Element size:");
+    element_size->setValidator(new QDoubleValidator(0, 1e300, 16, element_size));
+    element_size->setToolTip("Maximum side of quadrangles, leave empty to split the "
+                             "straight skeleton of the domain instead");
     label_name->setText("Name:");
     cancel->setText("&Cancel");
     save->setText("&Save");
@@ -38,10 +52,12 @@ NewGeometryFromPslgDialog::NewGeometryFromPslgDialog(
     layout->addWidget(poly_file_name,0,1,1,2);
     layout->addWidget(button_browse,0,3);
     layout->addWidget(message,1,0,1,4);
-    layout->addWidget(label_name,2,0);
-    layout->addWidget(file_name,2,1);
-    layout->addWidget(cancel,2,2);
-    layout->addWidget(save, 2, 3);
+    layout->addWidget(label_size,2,0);
+    layout->addWidget(element_size,2,1,1,3);
+    layout->addWidget(label_name,3,0);
+    layout->addWidget(file_name,3,1);
+    layout->addWidget(cancel,3,2);
+    layout->addWidget(save, 3, 3);
     this->setLayout(layout);
     this->setWindowModality(Qt::ApplicationModal);
     this->setWindowTitle("New Geometry From PSLG...");
@@ -60,6 +76,8 @@ NewGeometryFromPslgDialog::~NewGeometryFromPslgDialog()
     delete label_poly_file;
     delete poly_file_name;
     delete message;
+    delete label_size;
+    delete element_size;
     delete button_browse;
     delete label_name;
     delete file_name;
@@ -96,18 +114,48 @@ void NewGeometryFromPslgDialog::saveFile()
         message.exec();
         return;
     }
-    if(!SemSolver::PreProcessor::compute_polygonation_from_pslg(pslg, polygonation))
+    double size = element_size->text().isEmpty() ? 0. : element_size->text().toDouble();
+
+    // subdomains of an unchanged PSLG are taken from memory or from the workspace,
+    // in the form they are read back from the geometry
+    QByteArray hash = SemSolver::PreProcessor::compute_pslg_hash(pslg, size);
+    SemSolver::PolygonationCache<double> &cache =
+            SemSolver::PolygonationCache<double>::global();
+    if(!cache.find(hash, polygonation))
     {
-        QMessageBox message;
-        message.setText("Error. The PSLG does not describe a valid polygon with holes.");
-        message.exec();
-        return;
+        QByteArray data;
+        if(!SemSolver::IO::get_cached_subdomains_from_workspace(workspace, hash, data))
+        {
+            bool ok = false;
+            if(size>0)
+                ok = SemSolver::PreProcessor::compute_quadrangulation_from_pslg(
+                        pslg, size, polygonation);
+            else
+                ok = SemSolver::PreProcessor::compute_polygonation_from_pslg(pslg,
+                                                                             polygonation);
+            if(!ok)
+            {
+                QMessageBox message;
+                message.setText("Error. The PSLG does not describe a valid polygon with h"
+                                "oles.");
+                message.exec();
+                return;
+            }
+            if(!polygonation.isQuadrangulation())
+                polygonation.refine();
+            QBuffer buffer;
+            SemSolver::IO::write_subdomains(polygonation, &buffer);
+            data = buffer.data();
+            SemSolver::IO::add_cached_subdomains_to_workspace(workspace, hash, data);
+        }
+        QBuffer buffer;
+        buffer.setData(data);
+        SemSolver::IO::read_subdomains(&buffer, polygonation);
+        cache.insert(hash, polygonation);
     }
-    if(!polygonation.isQuadrangulation())
-                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                        polygonation.refine();
     QTemporaryFile domains_file;
     SemSolver::IO::write_subdomains(polygonation, &domains_file);
-    SemSolver::IO::write_geometry(poly_file, &domains_file, &semgeo_file);
+    SemSolver::IO::write_geometry(poly_file, &domains_file, &semgeo_file, hash);
     done(true);
 };
 
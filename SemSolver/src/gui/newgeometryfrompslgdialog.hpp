@@ -21,6 +21,8 @@ class NewGeometryFromPslgDialog : public QDialog
     QLabel *label_poly_file;
     QLabel *poly_file_name;
     QLabel *message;
+    QLabel *label_size;
+    QLineEdit *element_size;
     QPushButton *button_browse;
     QLabel *label_name;
     QLineEdit *file_name;
@@ -32,10 +34,12 @@ class NewGeometryFromPslgDialog : public QDialog
     QFile *poly_file;
 
     const QStringList &geometries;
+    QFile *workspace;
 
 public:
     NewGeometryFromPslgDialog(QWidget *parent,
-                              QStringList const &existing_geometries);
+                              QStringList const &existing_geometries,
+                              QFile *workspace_file);
     ~NewGeometryFromPslgDialog();
     inline QFile *file()
     {
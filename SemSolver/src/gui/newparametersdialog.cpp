@@ -12,21 +12,54 @@ NewParametersDialog::NewParametersDialog(
     input_layout0 = new QHBoxLayout;
     input_layout1 = new QHBoxLayout;
     input_layout2 = new QHBoxLayout;
+    input_layout3 = new QHBoxLayout;
+    input_layout4 = new QHBoxLayout;
+    input_layout5 = new QHBoxLayout;
+    input_layout6 = new QHBoxLayout;
     degree_label = new QLabel(this);
     degree_value = new QLineEdit(this);
     tolerance_label = new QLabel(this);
     tolerance_value = new QLineEdit(this);
     penality_label = new QLabel(this);
     penality_value = new QLineEdit(this);
+    ordering_label = new QLabel(this);
+    ordering_value = new QComboBox(this);
+    adaptivity_label = new QLabel(this);
+    adaptive_tolerance_value = new QLineEdit(this);
+    adaptive_steps_value = new QLineEdit(this);
+    smoothing_label = new QLabel(this);
+    smoothing_steps_value = new QLineEdit(this);
+    refinement_label = new QLabel(this);
+    refinement_levels_value = new QLineEdit(this);
     degree_label->setText("<b>Degree</b>");
     tolerance_label->setText("<b>Tolerance</b>");
     penality_label->setText("<b>Penality</b>");
+    ordering_label->setText("<b>Ordering</b>");
+    adaptivity_label->setText("<b>Adaptivity</b>");
+    adaptive_tolerance_value->setToolTip("Target error, leave empty to disable adaptive refinement");
+    adaptive_steps_value->setToolTip("Maximum number of refinement steps");
+    smoothing_label->setText("<b>Smoothing</b>");
+    smoothing_steps_value->setToolTip("Number of mesh smoothing sweeps, leave empty to disable smoothing");
+    refinement_label->setText("<b>Refinement</b>");
+    refinement_levels_value->setToolTip("Number of uniform refinements of subdomains, leave empty to disable refinement");
+    ordering_value->addItem("Native", "NATIVE");
+    ordering_value->addItem("Morton curve", "MORTON");
+    ordering_value->addItem("Hilbert curve", "HILBERT");
     input_layout0->addWidget(degree_label);
     input_layout0->addWidget(degree_value);
     input_layout1->addWidget(tolerance_label);
     input_layout1->addWidget(tolerance_value);
     input_layout2->addWidget(penality_label);
     input_layout2->addWidget(penality_value);
+    input_layout3->addWidget(ordering_label);
+    input_layout3->addWidget(ordering_value);
+    input_layout4->addWidget(adaptivity_label);
+    input_layout4->addWidget(adaptive_tolerance_value);
+    input_layout4->addWidget(adaptive_steps_value);
+    input_layout5->addWidget(smoothing_label);
+    input_layout5->addWidget(smoothing_steps_value);
+    input_layout6->addWidget(refinement_label);
+    input_layout6->addWidget(refinement_levels_value);
     message = new QLabel(this);
     message->setAlignment(Qt::AlignRight);
     message->setText("");
@@ -50,6 +83,10 @@ NewParametersDialog::NewParametersDialog(
     layout->addLayout(input_layout0);
     layout->addLayout(input_layout1);
     layout->addLayout(input_layout2);
+    layout->addLayout(input_layout3);
+    layout->addLayout(input_layout4);
+    layout->addLayout(input_layout5);
+    layout->addLayout(input_layout6);
     layout->addWidget(message);
     layout->addWidget(bottom_widget);
     this->setLayout(layout);
@@ -57,6 +94,10 @@ NewParametersDialog::NewParametersDialog(
     connect(degree_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
     connect(tolerance_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
     connect(penality_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
+    connect(adaptive_tolerance_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
+    connect(adaptive_steps_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
+    connect(smoothing_steps_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
+    connect(refinement_levels_value, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
     connect(cancel, SIGNAL(clicked()), this, SLOT(close()));
     connect(button_save, SIGNAL(clicked()), this, SLOT(save()));
     connect(line_name, SIGNAL(textChanged(QString)), this, SLOT(checkInput()));
@@ -71,6 +112,15 @@ NewParametersDialog::~NewParametersDialog()
     delete tolerance_value;
     delete penality_label;
     delete penality_value;
+    delete ordering_label;
+    delete ordering_value;
+    delete adaptivity_label;
+    delete adaptive_tolerance_value;
+    delete adaptive_steps_value;
+    delete smoothing_label;
+    delete smoothing_steps_value;
+    delete refinement_label;
+    delete refinement_levels_value;
     delete label;
     delete line_name;
     delete cancel;
@@ -78,6 +128,10 @@ NewParametersDialog::~NewParametersDialog()
     delete input_layout0;
     delete input_layout1;
     delete input_layout2;
+    delete input_layout3;
+    delete input_layout4;
+    delete input_layout5;
+    delete input_layout6;
     delete bottom_layout;
     delete bottom_widget;
     delete layout;
@@ -121,6 +175,49 @@ void NewParametersDialog::checkInput()
         return;
     }
 
+    //check adaptivity values, they are optional
+    if(!adaptive_tolerance_value->text().isEmpty() || !adaptive_steps_value->text().isEmpty())
+    {
+        double adaptive_tolerance = adaptive_tolerance_value->text().toDouble(&ok);
+        if (!ok || adaptive_tolerance<=0)
+        {
+            button_save->setEnabled(false);
+            message->setText("Target error must be a positive floating point number");
+            return;
+        }
+        int adaptive_steps = adaptive_steps_value->text().toInt(&ok);
+        if (!ok || adaptive_steps<1)
+        {
+            button_save->setEnabled(false);
+            message->setText("Refinement steps must be a positive integer");
+            return;
+        }
+    }
+
+    //check smoothing value, it is optional
+    if(!smoothing_steps_value->text().isEmpty())
+    {
+        int smoothing_steps = smoothing_steps_value->text().toInt(&ok);
+        if (!ok || smoothing_steps<1)
+        {
+            button_save->setEnabled(false);
+            message->setText("Smoothing sweeps must be a positive integer");
+            return;
+        }
+    }
+
+    //check refinement value, it is optional
+    if(!refinement_levels_value->text().isEmpty())
+    {
+        int refinement_levels = refinement_levels_value->text().toInt(&ok);
+        if (!ok || refinement_levels<1)
+        {
+            button_save->setEnabled(false);
+            message->setText("Refinement levels must be a positive integer");
+            return;
+        }
+    }
+
     // if all checks are succesfully check name
     QString stringName = line_name->text();
     if(stringName.isEmpty())
@@ -156,6 +253,17 @@ void NewParametersDialog::save()
     out << "DEGREE    \t" + QString::number(degree) + "\n";
     out << "TOLERANCE \t" + QString::number(tolerance) + "\n";
     out << "PENALITY  \t" + QString::number(penality) + "\n";
+    if(ordering_value->currentIndex()>0)
+        out << "ORDERING  \t" + ordering_value->itemData(ordering_value->currentIndex())
+                .toString() + "\n";
+    if(!adaptive_tolerance_value->text().isEmpty())
+        out << "ADAPTIVITY\t" + QString::number(adaptive_tolerance_value->text().toDouble())
+                + "\t" + QString::number(adaptive_steps_value->text().toInt()) + "\n";
+    if(!smoothing_steps_value->text().isEmpty())
+        out << "SMOOTHING \t" + QString::number(smoothing_steps_value->text().toInt()) + "\n";
+    if(!refinement_levels_value->text().isEmpty())
+        out << "REFINEMENT\t" + QString::number(refinement_levels_value->text().toInt())
+                + "\n";
     temp_file.close();
     done(true);
 };
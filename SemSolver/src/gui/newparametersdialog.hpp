@@ -1,6 +1,7 @@
 #ifndef NEWPARAMETERSDIALOG_HPP
 #define NEWPARAMETERSDIALOG_HPP
 
+#include <QComboBox>
 #include <QDialog>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -22,12 +23,25 @@ class NewParametersDialog : public QDialog
     QHBoxLayout *input_layout0;
     QHBoxLayout *input_layout1;
     QHBoxLayout *input_layout2;
+    QHBoxLayout *input_layout3;
+    QHBoxLayout *input_layout4;
+    QHBoxLayout *input_layout5;
+    QHBoxLayout *input_layout6;
     QLabel *degree_label;
     QLineEdit *degree_value;
     QLabel *tolerance_label;
     QLineEdit *tolerance_value;
     QLabel *penality_label;
     QLineEdit *penality_value;
+    QLabel *ordering_label;
+    QComboBox *ordering_value;
+    QLabel *adaptivity_label;
+    QLineEdit *adaptive_tolerance_value;
+    QLineEdit *adaptive_steps_value;
+    QLabel *smoothing_label;
+    QLineEdit *smoothing_steps_value;
+    QLabel *refinement_label;
+    QLineEdit *refinement_levels_value;
     QWidget *bottom_widget;
     QHBoxLayout *bottom_layout;
     QLabel *label;
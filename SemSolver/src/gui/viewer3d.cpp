@@ -1,5 +1,7 @@
 #include "viewer3d.hpp"
 
+#include <vector>
+
 /*
 void Viewer3D::plotFunction(
         const SemSolver::Function<SemSolver::Point<2, double>, double> *function,
@@ -33,19 +35,24 @@ void Viewer3D::plotFunction(
         const int &xdiv,
         const int &ydiv)
 {
+    std::vector< SemSolver::Point<2, double> > points;
+    points.reserve((xdiv+1)*(ydiv+1));
+    for(int i=0; i<=xdiv; ++i)
+        for(int j=0; j<=ydiv; ++j)
+            points.push_back(SemSolver::Point<2, double>(xmin + i*(xmax-xmin)/xdiv,
+                                                         ymin + j*(ymax-ymin)/ydiv));
+    std::vector<double> values;
+    function->evaluateBatch(points, values);
     Qwt3D::Triple **data = new Qwt3D::Triple *[xdiv+1];
-    double x, y, z;
     for(int i=0; i<=xdiv; ++i)
     {
         data[i] = new Qwt3D::Triple[ydiv+1];
-        x = xmin + i*(xmax-xmin)/xdiv;
         for(int j=0; j<=ydiv; ++j)
         {
-            y = ymin + j*(ymax-ymin)/ydiv;
-            z = function->evaluate(SemSolver::Point<2, double>(x,y));
-            data[i][j].x = x;
-            data[i][j].y = y;
-            data[i][j].z = z;
+            int k = i*(ydiv+1)+j;
+            data[i][j].x = points[k].x();
+            data[i][j].y = points[k].y();
+            data[i][j].z = values[k];
         }
     }
     loadFromData(data,xdiv+1,ydiv+1);
@@ -13,6 +13,7 @@
 #include <SemSolver/Assembler/computebordermatrix.hpp>
 #include <SemSolver/Assembler/computeforcingvector.hpp>
 #include <SemSolver/Assembler/computebordervector.hpp>
+#include <SemSolver/Assembler/applyhangingnodeconstraints.hpp>
 
 namespace SemSolver
 {
@@ -22,9 +23,49 @@ namespace SemSolver
         information stored in a SemProblem. */
     namespace Assembler
     {
+        /*! Compute the constant term f of the algebraic system A * u = f associated to a
+            2D elliptic problem in a Spectral Element Space */
+        /*! Only forcing and boundary data are evaluated, so that a system whose matrix
+            is already known can be solved for new data without assembling it again.
+            Hanging nodes of the space are condensed out, see
+            condense_algebraic_vector */
+        template<class X>
+        void compute_algebraic_vector(const SemSpace<2, X> &space,
+                                      const Problem<2, X> &problem,
+                                      Vector<X> &f)
+        {
+            if( problem.equation()->type()==Equation<2, X>::DIFFUSION_CONVECTION_REACTION )
+            {
+                const DiffusionConvectionReactionEquation<2, X> *equation =
+                        (const DiffusionConvectionReactionEquation<2, X> *)problem.equation();
+                f = Vector<X>(space.nodes(),0.);
+                Vector<X> ff, fb;
+                if(equation->forcing())
+                {
+#ifdef SEMDEBUG
+                    qDebug() << "forcing vector";
+#endif
+                    Assembler::compute_forcing_vector(space, equation->forcing(), ff);
+                    f += ff;
+                }
+#ifdef SEMDEBUG
+                qDebug() << "border vector";
+#endif
+                Assembler::compute_border_vector(space,
+                                                 problem.boundaryConditions(),
+                                                 equation->diffusion(),
+                                                 problem.parameters()->penality(),
+                                                 fb);
+                f += fb;
+                Assembler::condense_algebraic_vector(space, f);
+            }
+        };
+
         /*! Compute the algebraic system A * u = f associated to a 2D elliptic problem in
             a Spectral Element Space */
         //! The computed system is stored in the Matrix and vectored refereced by A and f
+        /*! Hanging nodes of the space are condensed out, so that the values of u at
+            them must be set after solving with distribute_constrained_values */
         template<class X>
         void compute_algebraic_system(const SemSpace<2, X> &space,
                                       const Problem<2, X> &problem,
@@ -37,9 +78,7 @@ namespace SemSolver
                         (const DiffusionConvectionReactionEquation<2, X> *)problem.equation();
                 int n = space.nodes();
                 A = Matrix<X>(n,n,0.);
-                f = Vector<X>(n,0.);
                 Matrix<X> Ad, Ac, Ar, Ab;
-                Vector<X> ff, fb;
                 if(equation->diffusion())
                 {
 #ifdef SEMDEBUG
@@ -73,23 +112,8 @@ namespace SemSolver
                                                  problem.parameters()->penality(),
                                                  Ab);
                 A += Ab;
-                if(equation->forcing())
-                {
-#ifdef SEMDEBUG
-                    qDebug() << "forcing vector";
-#endif
-                    Assembler::compute_forcing_vector(space, equation->forcing(), ff);
-                    f += ff;
-                }
-#ifdef SEMDEBUG
-                qDebug() << "border vector";
-#endif
-                Assembler::compute_border_vector(space,
-                                                 problem.boundaryConditions(),
-                                                 equation->diffusion(),
-                                                 problem.parameters()->penality(),
-                                                 fb);
-                f += fb;
+                Assembler::condense_algebraic_matrix(space, A);
+                Assembler::compute_algebraic_vector(space, problem, f);
             }
         };
     };
@@ -26,12 +26,12 @@ namespace SemSolver
                                    Matrix<X> &matrix )
         {
             unsigned n = space.nodes();
-            int N = space.degree();
             unsigned Mb = space.borders();
 
             matrix = Matrix<X>(n,n,0.);
             for(unsigned i=0; i<Mb; ++i)
             {
+                int N = space.borderDegree(i);
                 for(int j=0; j<=N; ++j)
                 {
                     MultiIndex<2> mi;
@@ -25,7 +25,6 @@ namespace SemSolver
             typedef typename SemSpace<2, X>::Node Node;
 
             int n = space.nodes();
-            int N = space.degree();
 
             matrix = Matrix<X>(n,n,0.);
 
@@ -45,6 +44,7 @@ namespace SemSolver
                         else
                         {
                             int i = node0.subDomainIndex(l0).subIndex(0);
+                            int N = space.degree(i);
                             for (int j2=0; j2<=N; ++j2)
                             {
                                 for (int k2=0; k2<=N; ++k2)
@@ -56,8 +56,8 @@ namespace SemSolver
                                     X alpha = space.subDomainWeight(mi2);
                                     Point<2,X> x2 = space.subDomainNode(mi2).point();
                                     X mi = diffusion->evaluate(x2);
-                                    Vector<X> const &grad0 = space.baseFunction(I0)->evaluateRestrictionGradient(i,x2);
-                                    Vector<X> const &grad1 = space.baseFunction(I1)->evaluateRestrictionGradient(i,x2);
+                                    Vector<X> const &grad0 = space.evaluateBaseGradient(I0,i,j2,k2);
+                                    Vector<X> const &grad1 = space.evaluateBaseGradient(I1,i,j2,k2);
                                     matrix[I0][I1] += alpha * mi * scalar(grad1,grad0);
                                 }
                             }
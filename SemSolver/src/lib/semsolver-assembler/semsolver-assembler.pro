@@ -1,8 +1,10 @@
 TEMPLATE = subdirs
-HEADERS += computereactionmatrix.hpp \
+HEADERS += computesystemhash.hpp \
+    computereactionmatrix.hpp \
     computeforcingvector.hpp \
     computediffusionmatrix.hpp \
     computeconvectionmatrix.hpp \
     computebordervector.hpp \
     computebordermatrix.hpp \
-    computealgebraicsystem.hpp
+    computealgebraicsystem.hpp \
+    applyhangingnodeconstraints.hpp
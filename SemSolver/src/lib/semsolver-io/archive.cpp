@@ -1,11 +1,183 @@
 #include "archive.hpp"
 
+#include <QDateTime>
 #include <QFileInfo>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QtEndian>
+
+#include <cstring>
+
+//! Name of the trailing index entry of appended archives
+static const char index_name[] = ".semindex";
+
+//! Keyword of the pax record marking an entry as removed
+static const char deleted_keyword[] = "SEMSOLVER.deleted";
+
+//! Magic of block compressed entries
+/*! A compressed entry is made of, all values little-endian:
+    - 8 bytes magic "SEMBLKZ\1"
+    - quint64 uncompressed size, quint32 block size, quint32 number of blocks
+    - quint64 end offset of each compressed block, relative to the first block
+    - blocks compressed with qCompress */
+static const char compressed_magic[8] = {'S','E','M','B','L','K','Z','\1'};
+
+//! Size of uncompressed blocks
+static const qint64 compressed_block_size = 1 << 20;
+
+//! Size of compressed entries header
+static const qint64 compressed_header_size = 24;
+
+//! A block of data to be compressed or decompressed
+struct CompressedBlock
+{
+    const char *source;     //!< Block data
+    qint64     source_size; //!< Block data size
+    char       *target;     //!< Where to decompress block, 0 when compressing
+    qint64     target_size; //!< Size of decompressed block
+    QByteArray compressed;  //!< Compressed block
+    bool       ok;          //!< Whether decompression succeeded
+};
+
+//! Functor compressing a block
+struct CompressBlock
+{
+    typedef void result_type;
+
+    int level;
+
+    void operator()(CompressedBlock &block) const
+    {
+        block.compressed = qCompress((const uchar *)block.source, block.source_size,
+                                     level);
+    };
+};
+
+//! Functor decompressing a block in place
+struct DecompressBlock
+{
+    typedef void result_type;
+
+    void operator()(CompressedBlock &block) const
+    {
+        QByteArray data = qUncompress((const uchar *)block.source, block.source_size);
+        block.ok = (data.size()==block.target_size);
+        if(block.ok)
+            memcpy(block.target, data.constData(), data.size());
+    };
+};
+
+//! Test if data is a block compressed entry
+static bool is_compressed(const char *data, qint64 size)
+{
+    return size>=compressed_header_size && !memcmp(data, compressed_magic, 8);
+}
+
+//! Compress data in blocks on the global thread pool
+//! \return Compressed entry, or data itself if compression does not make it smaller
+static QByteArray compress_entry(const QByteArray &data, int level)
+{
+    if(is_compressed(data.constData(), data.size()))
+        return data;
+    QVector<CompressedBlock> blocks;
+    for(qint64 position=0; position<data.size(); position+=compressed_block_size)
+    {
+        CompressedBlock block;
+        block.source = data.constData()+position;
+        block.source_size = qMin(compressed_block_size, data.size()-position);
+        block.target = 0;
+        block.target_size = block.source_size;
+        block.ok = false;
+        blocks.push_back(block);
+    }
+    CompressBlock compress;
+    compress.level = level;
+    if(blocks.size()>1)
+        QtConcurrent::blockingMap(blocks, compress);
+    else if(blocks.size()==1)
+        compress(blocks[0]);
+
+    qint64 size = compressed_header_size + 8*blocks.size();
+    for(int i=0; i<blocks.size(); ++i)
+        size += blocks[i].compressed.size();
+    if(size>=data.size())
+        return data;
+    QByteArray entry(size, '\0');
+    uchar *header = (uchar *)entry.data();
+    memcpy(header, compressed_magic, 8);
+    qToLittleEndian<quint64>(data.size(), header+8);
+    qToLittleEndian<quint32>(compressed_block_size, header+16);
+    qToLittleEndian<quint32>(blocks.size(), header+20);
+    char *block_data = entry.data() + compressed_header_size + 8*blocks.size();
+    quint64 block_end = 0;
+    for(int i=0; i<blocks.size(); ++i)
+    {
+        memcpy(block_data+block_end, blocks[i].compressed.constData(),
+               blocks[i].compressed.size());
+        block_end += blocks[i].compressed.size();
+        qToLittleEndian<quint64>(block_end, header+compressed_header_size+8*i);
+    }
+    return entry;
+}
+
+//! Decompress a block compressed entry on the global thread pool
+static bool decompress_entry(const char *data, qint64 size, QByteArray &entry)
+{
+    const uchar *header = (const uchar *)data;
+    qint64 entry_size = qFromLittleEndian<quint64>(header+8);
+    qint64 block_size = qFromLittleEndian<quint32>(header+16);
+    qint64 count = qFromLittleEndian<quint32>(header+20);
+    qint64 table_end = compressed_header_size + 8*count;
+    if(entry_size<0 || entry_size>0x7fffffff || block_size<=0 || table_end>size
+       || count!=(entry_size+block_size-1)/block_size)
+        return false;
+    entry.resize(entry_size);
+    QVector<CompressedBlock> blocks(count);
+    qint64 block_begin = 0;
+    for(qint64 i=0; i<count; ++i)
+    {
+        qint64 block_end = qFromLittleEndian<quint64>(header+compressed_header_size+8*i);
+        if(block_end<block_begin || table_end+block_end>size)
+            return false;
+        CompressedBlock &block = blocks[i];
+        block.source = data+table_end+block_begin;
+        block.source_size = block_end-block_begin;
+        block.target = entry.data()+i*block_size;
+        block.target_size = qMin(block_size, entry_size-i*block_size);
+        block.ok = false;
+        block_begin = block_end;
+    }
+    DecompressBlock decompress;
+    if(count>1)
+        QtConcurrent::blockingMap(blocks, decompress);
+    else if(count==1)
+        decompress(blocks[0]);
+    for(qint64 i=0; i<count; ++i)
+        if(!blocks[i].ok)
+            return false;
+    return true;
+}
 
 SemSolver::IO::Archive::Archive(QFile *qfile)
     : file(qfile)
 {
     status = CLOSED;
+    mapped = 0;
+    base = 0;
+    length = 0;
+    end = 0;
+    level = 0;
+}
+
+SemSolver::IO::Archive::Archive(const QByteArray &data)
+    : file(0), memory(data)
+{
+    status = CLOSED;
+    mapped = 0;
+    base = 0;
+    length = 0;
+    end = 0;
+    level = 0;
 }
 
 bool SemSolver::IO::Archive::openRead()
@@ -13,83 +185,460 @@ bool SemSolver::IO::Archive::openRead()
 #ifdef SEMDEBUG
     if(status != CLOSED)
         qFatal("Archive must be closed before openread");
-    if(!file->exists())
+    if(file && !file->exists())
         return false;
 #endif
-    QFileInfo info(*file);
+    names.clear();
+    index.clear();
+    mapped = 0;
+    end = 0;
+    if(file)
+    {
+        if(!file->open(QIODevice::ReadOnly))
+            return false;
+        length = file->size();
+        if(length>0)
+            mapped = file->map(0, length);
+        if(!mapped)
+            memory = file->readAll();
+    }
+    base = mapped ? (const char *)mapped : memory.constData();
+    if(!mapped)
+        length = memory.size();
+    if(!indexTrailer() && !indexTar())
+    {
+        names.clear();
+        index.clear();
+        if(!indexArchive())
+        {
+            closeFile();
+            return false;
+        }
+    }
+    status = OPENREAD;
+    return true;
+};
+
+void SemSolver::IO::Archive::closeFile()
+{
+    if(!file)
+        return;
+    if(mapped)
+        file->unmap(mapped);
+    mapped = 0;
+    memory.clear();
+    file->close();
+};
+
+//! Parse a numeric field of a tar header
+//! Values are octal strings, or big-endian base-256 if the first bit is set
+static qint64 tar_number(const char *field, int length)
+{
+    qint64 value = 0;
+    if(field[0] & 0x80)
+    {
+        value = field[0] & 0x7f;
+        for(int i=1; i<length; ++i)
+            value = (value << 8) | (unsigned char)field[i];
+        return value;
+    }
+    int i = 0;
+    while(i<length && field[i]==' ')
+        ++i;
+    for(; i<length && field[i]>='0' && field[i]<='7'; ++i)
+        value = value*8 + (field[i]-'0');
+    return value;
+}
+
+//! Write a numeric field of a tar header
+//! Values not fitting octal digits are written in base-256
+static void set_tar_number(char *field, int length, qint64 value)
+{
+    if(value >= ((qint64)1 << (3*(length-1))))
+    {
+        for(int i=length-1; i>0; --i, value >>= 8)
+            field[i] = (char)(value & 0xff);
+        field[0] = (char)0x80;
+        return;
+    }
+    field[length-1] = '\0';
+    for(int i=length-2; i>=0; --i, value >>= 3)
+        field[i] = '0' + (value & 7);
+}
+
+//! Get a NUL-terminated string field of a tar header
+static QByteArray tar_string(const char *field, int length)
+{
+    int size = 0;
+    while(size<length && field[size])
+        ++size;
+    return QByteArray(field, size);
+}
+
+//! Test tar header checksum
+//! Checksum is computed with checksum field filled with spaces
+static bool tar_checksum(const char *header)
+{
+    qint64 checksum = 8*' ';
+    for(int i=0; i<512; ++i)
+        if(i<148 || i>=156)
+            checksum += (unsigned char)header[i];
+    return checksum == tar_number(header+148, 8);
+}
+
+//! Fill a ustar header of a regular file or of a pax extended header
+static void set_tar_header(char *header, const QByteArray &name, qint64 size, char type)
+{
+    memset(header, 0, 512);
+    memcpy(header, name.constData(), qMin(name.size(), 100));
+    set_tar_number(header+100, 8, 0644);
+    set_tar_number(header+108, 8, 0);
+    set_tar_number(header+116, 8, 0);
+    set_tar_number(header+124, 12, size);
+    set_tar_number(header+136, 12, QDateTime::currentDateTime().toTime_t());
+    header[156] = type;
+    memcpy(header+257, "ustar", 6);
+    memcpy(header+263, "00", 2);
+    memset(header+148, ' ', 8);
+    qint64 checksum = 0;
+    for(int i=0; i<512; ++i)
+        checksum += (unsigned char)header[i];
+    set_tar_number(header+148, 7, checksum);
+}
+
+//! Make a pax extended header record
+static QByteArray pax_record(const QByteArray &key, const QByteArray &value)
+{
+    int size = key.size() + value.size() + 3;
+    int length = size + QByteArray::number(size).size();
+    if(QByteArray::number(length).size() != QByteArray::number(size).size())
+        ++length;
+    return QByteArray::number(length) + ' ' + key + '=' + value + '\n';
+}
+
+//! Test if a block is filled with zeroes
+static bool is_zero_block(const char *block)
+{
+    for(int i=0; i<512; ++i)
+        if(block[i])
+            return false;
+    return true;
+}
+
+bool SemSolver::IO::Archive::indexTrailer()
+{
+    // skip end of archive and record padding
+    qint64 last = length - length%512;
+    while(last>=512 && is_zero_block(base+last-512))
+        last -= 512;
+    if(last<1024)
+        return false;
+
+    // trailing index ends with a "SEMINDEX <offset>" line
+    qint64 footer_end = last-1;
+    while(footer_end>=last-512 && !base[footer_end])
+        --footer_end;
+    if(footer_end<last-512 || base[footer_end]!='\n')
+        return false;
+    qint64 footer = footer_end-1;
+    while(footer>=last-1024 && base[footer]!='\n')
+        --footer;
+    if(footer<last-1024)
+        return false;
+    QByteArray line = QByteArray::fromRawData(base+footer+1, footer_end-footer-1);
+    if(!line.startsWith("SEMINDEX "))
+        return false;
+    bool ok;
+    qint64 header = line.mid(9).toLongLong(&ok);
+    if(!ok || header<0 || header+512>length || header%512)
+        return false;
+    const char *block = base+header;
+    qint64 size = tar_number(block+124, 12);
+    if(!tar_checksum(block) || block[156]!='0' || tar_string(block, 100)!=index_name
+       || header+512+size!=footer_end+1)
+        return false;
+
+    qint64 position = header+512;
+    while(position<=footer)
+    {
+        qint64 line_end = position;
+        while(base[line_end]!='\n')
+            ++line_end;
+        line = QByteArray::fromRawData(base+position, line_end-position);
+        int first = line.indexOf(' ');
+        int second = line.indexOf(' ', first+1);
+        if(first<0 || second<0)
+            return false;
+        Entry entry;
+        entry.offset = line.left(first).toLongLong(&ok);
+        if(!ok)
+            return false;
+        entry.size = line.mid(first+1, second-first-1).toLongLong(&ok);
+        if(!ok || entry.offset<0 || entry.size<0 || entry.offset+entry.size>header)
+            return false;
+        entry.compressed = is_compressed(base+entry.offset, entry.size);
+        QString name = QString::fromUtf8(line.mid(second+1));
+        if(!index.contains(name))
+            names.push_back(name);
+        index.insert(name, entry);
+        position = line_end+1;
+    }
+    end = last;
+    return true;
+}
+
+bool SemSolver::IO::Archive::indexTar()
+{
+    qint64 position = 0;
+    QString long_name;
+    qint64 long_size = -1;
+    bool deleted = false;
+    while(position+512 <= length)
+    {
+        const char *header = base+position;
+
+        // end of archive
+        if(is_zero_block(header))
+            break;
+
+        // a corrupted header after valid entries is taken as the end of an
+        // interrupted append, entries before it are kept
+        if(!tar_checksum(header))
+        {
+            if(position)
+                break;
+            return false;
+        }
+
+        char type = header[156];
+        qint64 size = tar_number(header+124, 12);
+        bool is_file = (type=='0' || type=='\0' || type=='7');
+        if(is_file && long_size>=0)
+            size = long_size;
+        qint64 data = position+512;
+        if(size<0 || data+size>length)
+        {
+            if(position)
+                break;
+            return false;
+        }
+
+        if(type=='L')
+        {
+            // GNU long name for next entry
+            long_name = QString::fromLatin1(tar_string(base+data, size));
+        }
+        else if(type=='x')
+        {
+            // pax extended header for next entry
+            QByteArray extension = QByteArray::fromRawData(base+data, size);
+            int record = 0;
+            while(record<extension.size())
+            {
+                int space = extension.indexOf(' ', record);
+                if(space<0)
+                    break;
+                int record_length = extension.mid(record, space-record).toInt();
+                if(record_length<=0 || record+record_length>extension.size())
+                    break;
+                QByteArray pair = extension.mid(space+1, record+record_length-space-2);
+                int equal = pair.indexOf('=');
+                if(equal>0)
+                {
+                    QByteArray key = pair.left(equal);
+                    if(key=="path")
+                        long_name = QString::fromUtf8(pair.mid(equal+1));
+                    else if(key=="size")
+                        long_size = pair.mid(equal+1).toLongLong();
+                    else if(key==deleted_keyword)
+                        deleted = true;
+                }
+                record += record_length;
+            }
+        }
+        else
+        {
+            if(is_file)
+            {
+                QString name = long_name;
+                if(name.isNull())
+                {
+                    QByteArray path = tar_string(header, 100);
+                    QByteArray prefix = tar_string(header+345, 155);
+                    if(!strncmp(header+257, "ustar", 5) && !prefix.isEmpty())
+                        path = prefix + '/' + path;
+                    name = QString::fromLatin1(path);
+                }
+                if(deleted)
+                {
+                    if(index.remove(name))
+                        names.removeAll(name);
+                }
+                else if(name!=index_name)
+                {
+                    Entry entry;
+                    entry.offset = data;
+                    entry.size = size;
+                    entry.compressed = is_compressed(base+data, size);
+                    if(!index.contains(name))
+                        names.push_back(name);
+                    index.insert(name, entry);
+                }
+            }
+            long_name = QString();
+            long_size = -1;
+            deleted = false;
+        }
+        position = data + (size+511)/512*512;
+    }
+    end = position;
+    return true;
+}
+
+bool SemSolver::IO::Archive::indexArchive()
+{
     archive = archive::archive_read_new();
-    archive::archive_read_support_compression_none(archive);
+    archive::archive_read_support_compression_all(archive);
     archive::archive_read_support_format_all(archive);
-    if(archive::archive_read_open_filename(archive,
-                                           info.canonicalFilePath().toLatin1(),
-                                           ARCHIVE_DEFAULT_BYTES_PER_BLOCK)
+    if(archive::archive_read_open_memory(archive, const_cast<char *>(base), length)
         != ARCHIVE_OK)
+    {
+        archive::archive_read_finish(archive);
         return false;
-    status = OPENREAD;
+    }
+    archive::archive_entry *archive_entry;
+    while (archive::archive_read_next_header(archive, &archive_entry) == ARCHIVE_OK)
+    {
+        QString name(archive::archive_entry_pathname(archive_entry));
+        Entry entry;
+        entry.offset = -1;
+        entry.size = archive::archive_entry_size(archive_entry);
+        entry.data.resize(entry.size);
+        qint64 read = 0;
+        while(read<entry.size)
+        {
+            ssize_t bytes = archive::archive_read_data(archive, entry.data.data()+read,
+                                                       entry.size-read);
+            if(bytes<=0)
+            {
+                archive::archive_read_finish(archive);
+                return false;
+            }
+            read += bytes;
+        }
+        entry.compressed = is_compressed(entry.data.constData(), entry.size);
+        if(!index.contains(name))
+            names.push_back(name);
+        index.insert(name, entry);
+    }
+    archive::archive_read_finish(archive);
     return true;
-};
+}
 
 QStringList SemSolver::IO::Archive::entries()
 {
 #ifdef SEMDEBUG
-    if(status != OPENREAD)
+    if(status != OPENREAD && status != OPENAPPEND)
         qFatal("You must openRead archive before reading entries");
 #endif
-    closeRead();
-    openRead();
-    QStringList list;
-    archive::archive_entry *entry;
-    while (archive::archive_read_next_header(archive, &entry) == ARCHIVE_OK)
-        list.push_back(archive::archive_entry_pathname(entry));
-    return list;
+    return names;
 }
 
-bool SemSolver::IO::Archive::extractFile(const QString &name, QFile *file)
+bool SemSolver::IO::Archive::contains(const QString &name) const
+{
+#ifdef SEMDEBUG
+    if(status != OPENREAD && status != OPENAPPEND)
+        qFatal("You must openRead archive before reading entries");
+#endif
+    return index.contains(name);
+}
+
+qint64 SemSolver::IO::Archive::usedSize() const
+{
+    return end;
+}
+
+qint64 SemSolver::IO::Archive::wastedSize() const
+{
+    qint64 live = 0;
+    for(QHash<QString, Entry>::const_iterator it=index.begin(); it!=index.end(); ++it)
+        live += 512 + (it->size+511)/512*512;
+    return end>live ? end-live : 0;
+}
+
+bool SemSolver::IO::Archive::hasCompressedEntries() const
+{
+    for(QHash<QString, Entry>::const_iterator it=index.begin(); it!=index.end(); ++it)
+        if(it->compressed)
+            return true;
+    return false;
+}
+
+bool SemSolver::IO::Archive::storedEntryData(const QString &name, QByteArray &data)
 {
 #ifdef SEMDEBUG
     if(status != OPENREAD)
         qFatal("You must openRead archive before extracting entries");
 #endif
-    closeRead();
-    openRead();
-    archive::archive_entry *entry;
+    QHash<QString, Entry>::const_iterator it = index.find(name);
+    if(it==index.end())
+        return false;
+    if(it->offset<0)
+        data = it->data;
+    else
+        data = QByteArray::fromRawData(base+it->offset, it->size);
+    return true;
+}
 
-    while (archive::archive_read_next_header(archive, &entry) == ARCHIVE_OK)
+bool SemSolver::IO::Archive::entryData(const QString &name, QByteArray &data)
+{
+    if(!storedEntryData(name, data))
+        return false;
+    Entry &entry = index[name];
+    if(!entry.compressed)
+        return true;
+    if(entry.uncompressed.isNull()
+       && !decompress_entry(data.constData(), data.size(), entry.uncompressed))
     {
-        if(QString(archive::archive_entry_pathname(entry))==name)
-        {
-            if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
-                return false;
-            qint64 size = archive::archive_entry_size(entry);
-            char *data = new char[size];
-            if(size != archive::archive_read_data(archive, data,size))
-            {
-                delete[] data;
-                return false;
-            }
-            if(size!=file->write(data, size))
-            {
-                delete[] data;
-                return false;
-            }
-            delete[] data;
-            file->close();
-            return true;
-        }
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::Archive::entryData - ERROR : corrupted compressed entry.");
+#endif
+        entry.uncompressed = QByteArray();
+        return false;
     }
-    return false;
+    data = entry.uncompressed;
+    return true;
 }
 
-bool SemSolver::IO::Archive::closeRead()
+bool SemSolver::IO::Archive::extractFile(const QString &name, QFile *file)
 {
 #ifdef SEMDEBUG
     if(status != OPENREAD)
-        qFatal("You must openRead archive before closing it");
+        qFatal("You must openRead archive before extracting entries");
 #endif
-    if (archive::archive_read_finish(archive) != ARCHIVE_OK)
+    QByteArray data;
+    if(!entryData(name, data))
+        return false;
+    if(!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    if(data.size()!=file->write(data))
     {
+        file->close();
         return false;
     }
+    file->close();
+    return true;
+}
+
+bool SemSolver::IO::Archive::closeRead()
+{
+#ifdef SEMDEBUG
+    if(status != OPENREAD)
+        qFatal("You must openRead archive before closing it");
+#endif
+    closeFile();
+    names.clear();
+    index.clear();
     status = CLOSED;
     return true;
 }
@@ -136,27 +685,161 @@ bool SemSolver::IO::Archive::openWrite()
     return true;
 }
 
+bool SemSolver::IO::Archive::openAppend()
+{
+#ifdef SEMDEBUG
+    if(status != CLOSED)
+        qFatal("archive is not closed while attempting to open it in append mode");
+#endif
+    if(!file)
+        return false;
+    names.clear();
+    index.clear();
+    end = 0;
+    if(file->exists() && file->size()>0)
+    {
+        if(!openRead())
+            return false;
+        closeFile();
+        status = CLOSED;
+        // only plain tar archives can be appended in place
+        for(QHash<QString, Entry>::const_iterator it=index.begin(); it!=index.end(); ++it)
+        {
+            if(it->offset<0)
+            {
+                names.clear();
+                index.clear();
+                return false;
+            }
+        }
+    }
+    if(!file->open(QIODevice::ReadWrite))
+        return false;
+    if(!file->seek(end))
+    {
+        file->close();
+        return false;
+    }
+    status = OPENAPPEND;
+    return true;
+}
+
+bool SemSolver::IO::Archive::appendMember(const QByteArray &data,
+                                          const QString &name,
+                                          bool const &deleted)
+{
+    static const char padding[512] = {0};
+    char header[512];
+    QByteArray path = name.toLatin1();
+    QByteArray records;
+    if(path.size()>100 || QString::fromLatin1(path)!=name)
+        records += pax_record("path", name.toUtf8());
+    if(deleted)
+        records += pax_record(deleted_keyword, "1");
+    if(!records.isEmpty())
+    {
+        set_tar_header(header, "PaxHeader", records.size(), 'x');
+        if(file->write(header, 512)!=512 || file->write(records)!=records.size()
+           || file->write(padding, (512-records.size()%512)%512)
+              !=(512-records.size()%512)%512)
+            return false;
+    }
+    set_tar_header(header, path, data.size(), '0');
+    if(file->write(header, 512)!=512)
+        return false;
+    qint64 offset = file->pos();
+    if(file->write(data)!=data.size()
+       || file->write(padding, (512-data.size()%512)%512)!=(512-data.size()%512)%512)
+        return false;
+    end = file->pos();
+    if(deleted)
+    {
+        if(index.remove(name))
+            names.removeAll(name);
+    }
+    else if(name!=index_name)
+    {
+        Entry entry;
+        entry.offset = offset;
+        entry.size = data.size();
+        entry.compressed = is_compressed(data.constData(), data.size());
+        if(!index.contains(name))
+            names.push_back(name);
+        index.insert(name, entry);
+    }
+    return true;
+}
+
+bool SemSolver::IO::Archive::removeEntry(const QString &name)
+{
+#ifdef SEMDEBUG
+    if(status != OPENAPPEND)
+        qFatal("You must openAppend archive before removing entries");
+#endif
+    if(!index.contains(name))
+        return true;
+    return appendMember(QByteArray(), name, true);
+}
+
+bool SemSolver::IO::Archive::closeAppend()
+{
+#ifdef SEMDEBUG
+    if(status != OPENAPPEND)
+        qFatal("You must openAppend archive before closing it");
+#endif
+    static const char zeroes[1024] = {0};
+    QByteArray content;
+    for(int i=0; i<names.size(); ++i)
+    {
+        Entry const &entry = index[names[i]];
+        content += QByteArray::number(entry.offset) + ' ' + QByteArray::number(entry.size)
+                   + ' ' + names[i].toUtf8() + '\n';
+    }
+    content += "SEMINDEX " + QByteArray::number(end) + '\n';
+    bool ok = appendMember(content, index_name, false);
+    ok = ok && file->write(zeroes, 1024)==1024;
+    ok = ok && file->resize(file->pos());
+    file->close();
+    names.clear();
+    index.clear();
+    status = CLOSED;
+    return ok;
+}
+
 bool SemSolver::IO::Archive::addFile(QFile *file,
                                      const QString &name)
 {
 #ifdef SEMDEBUG
-    if(status != OPENWRITE)
+    if(status != OPENWRITE && status != OPENAPPEND)
         qFatal("You must openWrtie archive before adding entries");
     if(!file->exists())
         return false;
 #endif
-    qint64 size = file->size();
+    if(!file->open(QIODevice::ReadOnly))
+        return false;
+    QByteArray data = file->readAll();
+    file->close();
+    return addData(data, name);
+};
+
+bool SemSolver::IO::Archive::addData(const QByteArray &data,
+                                     const QString &name)
+{
+#ifdef SEMDEBUG
+    if(status != OPENWRITE && status != OPENAPPEND)
+        qFatal("You must openWrtie archive before adding entries");
+#endif
+    QByteArray stored = level>0 ? compress_entry(data, level) : data;
+    if(status == OPENAPPEND)
+        return appendMember(stored, name, false);
+    qint64 size = stored.size();
     archive::archive_entry *entry = archive::archive_entry_new();
     archive::archive_entry_set_pathname(entry, name.toLatin1());
     archive::archive_entry_set_size(entry, size);
     archive::archive_entry_set_filetype(entry, AE_IFREG);
     archive::archive_entry_set_perm(entry, 0644);
     archive::archive_write_header(archive, entry);
-    if(!file->open(QIODevice::ReadOnly))
-        return false;
-    QByteArray data = file->readAll();
-    file->close();
-    archive::archive_write_data(archive, data.constData(), size);
+    archive::archive_write_data(archive, stored.constData(), size);
     archive::archive_entry_free(entry);
     return true;
 };
@@ -1,7 +1,9 @@
 #ifndef IO_ARCHIVE_HPP
 #define IO_ARCHIVE_HPP
 
+#include <QByteArray>
 #include <QFile>
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QTemporaryFile>
@@ -14,7 +16,24 @@ namespace SemSolver
     //! Namespace for Input/Output operations on SemSolver Classes
     namespace IO
     {
-        //! Class for handling tar uncompressed archives
+        //! Class for handling tar archives
+        /*! When opened in read mode an index of entries is built in a single pass.
+            Entries of plain tar files are then served from a memory mapping of the
+            archive, other formats are decoded once into memory. Archives can also be
+            read from a memory buffer, e.g. an entry of another archive.
+
+            In append mode entries are written after the existing ones and removed
+            entries are marked by a tombstone, i.e. an empty entry with a pax record
+            SEMSOLVER.deleted. When closed a trailing index ".semindex" is appended
+            so that the next openRead needs not to scan headers. The result is still
+            a valid tar file, where later entries override earlier ones.
+
+            Entries can be stored compressed when a compression level is set. Data is
+            split in blocks of 1 MiB which are compressed with zlib in parallel, and
+            the entry starts with a table of block sizes, so that a compressed entry
+            is decompressed block-parallel only when its data is first requested.
+            Compressed entries are recognized by their leading magic, archives can
+            mix compressed and uncompressed entries. */
         class Archive
         {
             //! Archive status
@@ -23,18 +42,58 @@ namespace SemSolver
             {
                 CLOSED,
                 OPENREAD,
-                OPENWRITE
+                OPENWRITE,
+                OPENAPPEND
             };
 
-            archive::archive *archive;
-            QFile            *file;
-            Status           status;
+            //! Position of an entry in the archive
+            struct Entry
+            {
+                qint64     offset; //!< Offset of entry data, -1 if stored in data
+                qint64     size;   //!< Size of entry data
+                QByteArray data;   //!< Entry data if not stored at offset
+                bool       compressed;   //!< Whether data is block compressed
+                QByteArray uncompressed; //!< Decompressed data, once requested
+            };
+
+            archive::archive      *archive;
+            QFile                 *file;
+            Status                status;
+            QStringList           names;
+            QHash<QString, Entry> index;
+            uchar                 *mapped;
+            QByteArray            memory;
+            char const            *base;
+            qint64                length;
+            qint64                end;
+            int                   level;
+
+            //! Build entries index reading the trailing index of appended archives
+            bool indexTrailer();
+
+            //! Build entries index reading tar headers directly
+            bool indexTar();
+
+            //! Build entries index decoding archive with libarchive
+            bool indexArchive();
+
+            //! Release archive file and its mapping
+            void closeFile();
+
+            //! Write an entry at the end of archive in append mode
+            bool appendMember(QByteArray const &data,
+                              QString const &name,
+                              bool const &deleted);
 
         public:
             //! Default constructor
             //! file pointer to archive file
             Archive(QFile *file);
 
+            //! Constructor of a read only archive in memory
+            //! data content of the archive
+            Archive(QByteArray const &data);
+
             //! Open archive in read mode
             bool openRead();
 
@@ -47,9 +106,61 @@ namespace SemSolver
             //! Close archive in write mode
             bool closeWrite();
 
+            //! Open archive in append mode
+            //! Fails if archive is not an uncompressed tar file
+            bool openAppend();
+
+            //! Close archive in append mode writing the trailing index
+            bool closeAppend();
+
+            //! Remove an entry from archive in append mode
+            //! \param name Name of the entry
+            bool removeEntry(QString const &name);
+
+            //! Get size of archive entries, including overridden and removed ones
+            qint64 usedSize() const;
+
+            //! Get size taken by overridden and removed entries
+            qint64 wastedSize() const;
+
             //! Get list of entries in archive
             QStringList entries();
 
+            //! Test if archive has an entry
+            //! \param name Name of the entry
+            bool contains(QString const &name) const;
+
+            //! Get an entry data
+            /*! No data is copied if the archive is memory mapped, so the returned array
+                is valid only until the archive is closed. Use QByteArray::detach to
+                keep it longer. Compressed entries are decompressed on first request */
+            //! \param name Name of the entry
+            //! \param data Reference to the array where to store entry data
+            bool entryData(QString const &name, QByteArray &data);
+
+            //! Get an entry data as stored in the archive, without decompressing it
+            /*! Stored data can be added to another archive as it is */
+            //! \param name Name of the entry
+            //! \param data Reference to the array where to store entry data
+            bool storedEntryData(QString const &name, QByteArray &data);
+
+            //! Set compression level of entries added from now on
+            //! \param compression_level zlib level from 1 to 9, 0 to store entries
+            //! uncompressed
+            inline void setCompressionLevel(int const &compression_level)
+            {
+                level = compression_level;
+            };
+
+            //! Get compression level of added entries
+            inline int compressionLevel() const
+            {
+                return level;
+            };
+
+            //! Test if archive has compressed entries
+            bool hasCompressedEntries() const;
+
             //! Add a new entry to archive
             //! \param name Name of the entry
             //! \param value Value of the entry
@@ -58,22 +169,26 @@ namespace SemSolver
                           QString const &name)
             {
             #if SEMDEBUG
-                if(status!=OPENWRITE)
+                if(status!=OPENWRITE && status!=OPENAPPEND)
                     qFatal("You must openWrite archive before adding entries");
             #endif
                 if(!file->exists())
                     return false;
-                QTemporaryFile *temp_file = new QTemporaryFile();
-                if(!temp_file->open(QIODevice::WriteOnly | QIODevice::Text))
-                    return false;
-                QTextStream out(temp_file);
+                QByteArray data;
+                QTextStream out(&data, QIODevice::WriteOnly | QIODevice::Text);
                 out << value;
-                temp_file->close();
-                addFile(temp_file, name);
-                delete temp_file;
-                return true;
+                out.flush();
+                return addData(data, name);
             };
 
+            //! Add a new entry to archive
+            /*! Data is compressed if a compression level is set, it makes the entry
+                smaller and it is not compressed already */
+            //! \param data Content of the entry
+            //! \param name Name of the entry
+            bool addData(QByteArray const &data,
+                         QString const &name);
+
             //! Add a new entry to archive
             //! \param file File to be used as entry
             bool addFile(QFile *file);
@@ -2,8 +2,10 @@
 #define IO_BOUNDARYCONDITIONS_HPP
 
 #include <QFile>
+#include <QIODevice>
 
 #include <SemSolver/boundaryconditions.hpp>
+#include <SemSolver/IO/nextnonemptlinevalues.hpp>
 
 namespace SemSolver
 {
@@ -12,7 +14,7 @@ namespace SemSolver
     {
         //! Read 2D BoundaryConditions from file
         template<class X>
-        bool read_boundary_conditions(QFile *file,
+        bool read_boundary_conditions(QIODevice *file,
                                     BoundaryConditions<2, X> &boundary_conditions);
     };
 };
@@ -20,7 +22,7 @@ namespace SemSolver
 #include <SemSolver/scriptfunction.hpp>
 
 template<class X>
-bool SemSolver::IO::read_boundary_conditions(QFile *file,
+bool SemSolver::IO::read_boundary_conditions(QIODevice *file,
                                            BoundaryConditions<2, X> &bc)
 {
     bc.clear();
@@ -4,12 +4,15 @@
 
 bool SemSolver::IO::write_geometry(QFile *pslg_file,
                                   QFile *subdomains_file,
-                                  QFile *file)
+                                  QFile *file,
+                                  QByteArray const &hash)
 {
     Archive archive(file);
     archive.openWrite();
     archive.addFile(pslg_file, "pslg.poly");
     archive.addFile(subdomains_file, "domains.semsub");
+    if(!hash.isEmpty())
+        archive.addData(hash, "domains.hash");
     archive.closeWrite();
     return true;
 }
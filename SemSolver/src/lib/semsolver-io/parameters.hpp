@@ -2,9 +2,11 @@
 #define IO_PARAMETERS_HPP
 
 #include <QFile>
+#include <QIODevice>
 #include <QTextStream>
 
 #include <SemSolver/semparameters.hpp>
+#include <SemSolver/IO/nextnonemptlinevalues.hpp>
 
 namespace SemSolver
 {
@@ -13,17 +15,22 @@ namespace SemSolver
     {
         //! Read SemParameters from file
         template<class X>
-        bool read_parameters(QFile *file,
+        bool read_parameters(QIODevice *file,
                             SemParameters<X> &parameters);
     };
 };
 
 
 template<class X>
-bool SemSolver::IO::read_parameters(QFile *file,
+bool SemSolver::IO::read_parameters(QIODevice *file,
                                    SemParameters<X> &parameters)
 {
     bool degree = false, tolerance = false, penality = false;
+    // ordering, adaptivity, smoothing and refinement lines are optional
+    parameters.setOrdering(SemParameters<X>::NATIVE);
+    parameters.setAdaptivity(0., 0);
+    parameters.setSmoothing(0);
+    parameters.setRefinement(0);
 #ifdef SEMDEBUG
     if(!file->open(QIODevice::ReadOnly))
     {
@@ -77,6 +84,105 @@ bool SemSolver::IO::read_parameters(QFile *file,
 #endif
             parameters.setPenality(values[1].toDouble(&penality));
         }
+        else if(values[0]=="ORDERING")
+        {
+#ifdef SEMDEBUG
+            if(values.size()!=2)
+            {
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong number of inpu"\
+                         "ts on ordering line.");
+                file->close();
+                return false;
+            }
+#endif
+            if(values[1]=="NATIVE")
+                parameters.setOrdering(SemParameters<X>::NATIVE);
+            else if(values[1]=="MORTON")
+                parameters.setOrdering(SemParameters<X>::MORTON);
+            else if(values[1]=="HILBERT")
+                parameters.setOrdering(SemParameters<X>::HILBERT);
+            else
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::IO::readParameters - ERROR : unknown ordering.");
+#endif
+                file->close();
+                return false;
+            }
+        }
+        else if(values[0]=="ADAPTIVITY")
+        {
+#ifdef SEMDEBUG
+            if(values.size()!=3)
+            {
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong number of inpu"\
+                         "ts on adaptivity line.");
+                file->close();
+                return false;
+            }
+#endif
+            bool tolerance_ok, steps_ok;
+            X adaptive_tolerance = values[1].toDouble(&tolerance_ok);
+            int adaptive_steps = values[2].toInt(&steps_ok);
+            if(!tolerance_ok || !steps_ok || adaptive_steps<0)
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong adaptivity val"\
+                         "ues.");
+#endif
+                file->close();
+                return false;
+            }
+            parameters.setAdaptivity(adaptive_tolerance, adaptive_steps);
+        }
+        else if(values[0]=="SMOOTHING")
+        {
+#ifdef SEMDEBUG
+            if(values.size()!=2)
+            {
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong number of inpu"\
+                         "ts on smoothing line.");
+                file->close();
+                return false;
+            }
+#endif
+            bool steps_ok;
+            int smoothing_steps = values[1].toInt(&steps_ok);
+            if(!steps_ok || smoothing_steps<0)
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong smoothing valu"\
+                         "e.");
+#endif
+                file->close();
+                return false;
+            }
+            parameters.setSmoothing(smoothing_steps);
+        }
+        else if(values[0]=="REFINEMENT")
+        {
+#ifdef SEMDEBUG
+            if(values.size()!=2)
+            {
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong number of inpu"\
+                         "ts on refinement line.");
+                file->close();
+                return false;
+            }
+#endif
+            bool levels_ok;
+            int refinement_levels = values[1].toInt(&levels_ok);
+            if(!levels_ok || refinement_levels<0)
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::IO::readParameters - ERROR : wrong refinement val"\
+                         "ue.");
+#endif
+                file->close();
+                return false;
+            }
+            parameters.setRefinement(refinement_levels);
+        }
 #ifdef SEMDEBUG
         else
         {
@@ -3,8 +3,13 @@ QT += script
 TARGET = SemSolver-IO
 TEMPLATE = lib
 CONFIG += static
-HEADERS += workspace.hpp \
+HEADERS += workspaceloader.hpp \
+    workspace.hpp \
+    vtk.hpp \
+    texttokenizer.hpp \
+    system.hpp \
     subdomains.hpp \
+    solution.hpp \
     pslg.hpp \
     parameters.hpp \
     nextnonemptlinevalues.hpp \
@@ -14,6 +19,9 @@ HEADERS += workspace.hpp \
     boundaryconditions.hpp \
     archive.hpp
 SOURCES += workspace.cpp \
+    texttokenizer.cpp \
+    system.cpp \
+    solution.cpp \
     nextnonemptlinevalues.cpp \
     geometry.cpp \
     archive.cpp
@@ -0,0 +1,154 @@
+#include "solution.hpp"
+
+#include <QtEndian>
+
+#include <cstring>
+
+//! Reverse byte order of count values of size bytes
+static void swap_bytes(char *data, quint64 count, int size)
+{
+    for(quint64 i=0; i<count; ++i, data+=size)
+        for(int j=0; j<size/2; ++j)
+            qSwap(data[j], data[size-1-j]);
+}
+
+SemSolver::IO::SolutionFile::SolutionFile(QFile *qfile)
+    : file(qfile)
+{
+    mapped = 0;
+    base = 0;
+    _version = 0;
+    _degree = 0;
+    _nodes = 0;
+    _elements = 0;
+    coordinates_offset = 0;
+    coefficients_offset = 0;
+    connectivity_offset = 0;
+    indices_offset = 0;
+}
+
+SemSolver::IO::SolutionFile::SolutionFile(QByteArray const &data)
+    : file(0), memory(data)
+{
+    mapped = 0;
+    base = 0;
+    _version = 0;
+    _degree = 0;
+    _nodes = 0;
+    _elements = 0;
+    coordinates_offset = 0;
+    coefficients_offset = 0;
+    connectivity_offset = 0;
+    indices_offset = 0;
+}
+
+SemSolver::IO::SolutionFile::~SolutionFile()
+{
+    close();
+}
+
+bool SemSolver::IO::SolutionFile::open()
+{
+    using namespace SolutionFormat;
+    if(file && !file->open(QIODevice::ReadOnly))
+        return false;
+    quint64 size = file ? file->size() : memory.size();
+    if(size<header_size)
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SolutionFile::open - ERROR : file too short.");
+#endif
+        close();
+        return false;
+    }
+    if(file && Q_BYTE_ORDER==Q_LITTLE_ENDIAN)
+        mapped = file->map(0, size);
+    if(mapped)
+        base = (char const *)mapped;
+    else
+    {
+        if(file)
+            memory = file->readAll();
+        base = memory.constData();
+    }
+    if(memcmp(base, magic, 8))
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SolutionFile::open - ERROR : not a binary solution fil"\
+                 "e.");
+#endif
+        close();
+        return false;
+    }
+    uchar const *header = (uchar const *)base;
+    _version = qFromLittleEndian<quint32>(header+8);
+    _degree = qFromLittleEndian<quint32>(header+16);
+    _nodes = qFromLittleEndian<quint64>(header+24);
+    _elements = qFromLittleEndian<quint64>(header+32);
+    coordinates_offset = qFromLittleEndian<quint64>(header+40);
+    coefficients_offset = qFromLittleEndian<quint64>(header+48);
+    connectivity_offset = qFromLittleEndian<quint64>(header+56);
+    bool corrupted = (_version!=1 && _version!=version) || coordinates_offset%8
+                     || coefficients_offset%8 || connectivity_offset%8
+                     || coordinates_offset+2*_nodes*sizeof(double)>size
+                     || coefficients_offset+_nodes*sizeof(double)>size
+                     || connectivity_offset+_elements*sizeof(qint32)>size;
+
+    // degrees of elements, if any, then offsets of their node indices
+    indices_offset = connectivity_offset;
+    if(!corrupted && _version>=2)
+    {
+        indices_offset += _elements*sizeof(qint32);
+        corrupted = indices_offset>size;
+        if(!corrupted && Q_BYTE_ORDER!=Q_LITTLE_ENDIAN)
+        {
+            // data() detaches a shared buffer
+            swap_bytes(memory.data()+connectivity_offset, _elements, sizeof(qint32));
+            base = memory.constData();
+        }
+    }
+    quint64 indices = 0;
+    if(!corrupted)
+    {
+        element_offsets.resize(_elements);
+        for(quint64 e=0; e<_elements && !corrupted; ++e)
+        {
+            quint64 N = degree(e);
+            corrupted = N<1 || N>_degree;
+            element_offsets[e] = indices;
+            indices += (N+1)*(N+1);
+        }
+    }
+    if(corrupted || indices_offset+indices*sizeof(qint32)>size)
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SolutionFile::open - ERROR : corrupted solution file.");
+#endif
+        close();
+        return false;
+    }
+    if(Q_BYTE_ORDER!=Q_LITTLE_ENDIAN)
+    {
+        char *data = memory.data();
+        swap_bytes(data+coordinates_offset, 2*_nodes, sizeof(double));
+        swap_bytes(data+coefficients_offset, _nodes, sizeof(double));
+        swap_bytes(data+indices_offset, indices, sizeof(qint32));
+        base = memory.constData();
+    }
+    return true;
+}
+
+void SemSolver::IO::SolutionFile::close()
+{
+    // solutions in memory keep their data
+    base = 0;
+    element_offsets.clear();
+    if(!file)
+        return;
+    if(mapped)
+        file->unmap(mapped);
+    mapped = 0;
+    memory.clear();
+    if(file->isOpen())
+        file->close();
+}
@@ -0,0 +1,138 @@
+#include "system.hpp"
+
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+//! Reverse byte order of count values of size bytes
+static void swap_bytes(char *data, quint64 count, int size)
+{
+    for(quint64 i=0; i<count; ++i, data+=size)
+        for(int j=0; j<size/2; ++j)
+            qSwap(data[j], data[size-1-j]);
+}
+
+QString SemSolver::IO::get_system_file_name(QString const &workspace,
+                                            QByteArray const &hash)
+{
+    QFileInfo info(workspace);
+    return info.absolutePath() + "/" + info.completeBaseName() + ".systems/"
+            + hash.toHex() + ".semsys";
+}
+
+SemSolver::IO::SystemFile::SystemFile(QFile *qfile)
+    : file(qfile)
+{
+    mapped = 0;
+    base = 0;
+    _version = 0;
+    _type = 0;
+    _size = 0;
+    matrix_offset = 0;
+    first_offset = 0;
+    second_offset = 0;
+    pivot_offset = 0;
+}
+
+SemSolver::IO::SystemFile::~SystemFile()
+{
+    close();
+}
+
+bool SemSolver::IO::SystemFile::open()
+{
+    using namespace SystemFormat;
+    typedef Solver::Factorization<double> Factorization;
+    if(!file->open(QIODevice::ReadOnly))
+        return false;
+    quint64 size = file->size();
+    if(size<header_size)
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SystemFile::open - ERROR : file too short.");
+#endif
+        close();
+        return false;
+    }
+    if(Q_BYTE_ORDER==Q_LITTLE_ENDIAN)
+        mapped = file->map(0, size);
+    if(mapped)
+        base = (char const *)mapped;
+    else
+    {
+        memory = file->readAll();
+        base = memory.constData();
+    }
+    if(memcmp(base, magic, 8))
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SystemFile::open - ERROR : not a binary system file.");
+#endif
+        close();
+        return false;
+    }
+    uchar const *header = (uchar const *)base;
+    _version = qFromLittleEndian<quint32>(header+8);
+    _type = qFromLittleEndian<quint32>(header+16);
+    _size = qFromLittleEndian<quint64>(header+24);
+    matrix_offset = qFromLittleEndian<quint64>(header+32);
+    first_offset = qFromLittleEndian<quint64>(header+40);
+    second_offset = qFromLittleEndian<quint64>(header+48);
+    pivot_offset = qFromLittleEndian<quint64>(header+56);
+    _hash = QByteArray(base+64, hash_size);
+    quint64 block = _size*_size*sizeof(double);
+    bool has_first = _type!=Factorization::NONE;
+    bool has_second = _type==Factorization::QR;
+    bool has_pivot = _type==Factorization::LU;
+    if(_version!=version || _type>Factorization::CHOLESKY || _size>=((quint64)1<<31)
+       || matrix_offset%8 || matrix_offset+block>size
+       || has_first!=(first_offset!=0) || first_offset%8 || first_offset+block>size
+       || has_second!=(second_offset!=0) || second_offset%8
+       || second_offset+block>size
+       || has_pivot!=(pivot_offset!=0) || pivot_offset%8
+       || pivot_offset+_size*sizeof(qint32)>size)
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::IO::SystemFile::open - ERROR : corrupted system file.");
+#endif
+        close();
+        return false;
+    }
+    if(Q_BYTE_ORDER!=Q_LITTLE_ENDIAN)
+    {
+        char *data = memory.data();
+        swap_bytes(data+matrix_offset, _size*_size, sizeof(double));
+        if(first_offset)
+            swap_bytes(data+first_offset, _size*_size, sizeof(double));
+        if(second_offset)
+            swap_bytes(data+second_offset, _size*_size, sizeof(double));
+        if(pivot_offset)
+            swap_bytes(data+pivot_offset, _size, sizeof(qint32));
+        base = memory.constData();
+    }
+    return true;
+}
+
+void SemSolver::IO::SystemFile::close()
+{
+    if(mapped)
+        file->unmap(mapped);
+    mapped = 0;
+    memory.clear();
+    base = 0;
+    if(file->isOpen())
+        file->close();
+}
+
+SemSolver::Solver::Factorization<double> SemSolver::IO::SystemFile::factorization() const
+{
+    typedef Solver::Factorization<double> Factorization;
+    if(!base || _type==Factorization::NONE)
+        return Factorization();
+    return Factorization(type(),
+                         _size,
+                         (double const *)(base+first_offset),
+                         second_offset ? (double const *)(base+second_offset) : 0,
+                         pivot_offset ? (int const *)(base+pivot_offset) : 0);
+}
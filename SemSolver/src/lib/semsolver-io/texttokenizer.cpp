@@ -0,0 +1,201 @@
+#include "texttokenizer.hpp"
+
+#include <QBuffer>
+#include <QFile>
+
+#include <cstring>
+
+//! Test if a character separates tokens
+static inline bool is_space(char const &c)
+{
+    return (unsigned char)c<=' ' && (c==' ' || (c>='\t' && c<='\r'));
+}
+
+SemSolver::IO::TextTokenizer::TextTokenizer(QIODevice *qdevice)
+    : device(qdevice)
+{
+    mapped = 0;
+    QFile *file = qobject_cast<QFile *>(device);
+    QBuffer *buffer = qobject_cast<QBuffer *>(device);
+    if(file && file->size()>0)
+        mapped = file->map(0, file->size());
+    if(mapped)
+    {
+        position = (char const *)mapped;
+        end = position + file->size();
+    }
+    else if(buffer)
+    {
+        position = buffer->data().constData();
+        end = position + buffer->data().size();
+    }
+    else
+    {
+        memory = device->readAll();
+        position = memory.constData();
+        end = position + memory.size();
+    }
+}
+
+SemSolver::IO::TextTokenizer::TextTokenizer(char const *begin, char const *end)
+    : device(0), mapped(0), position(begin), end(end)
+{
+}
+
+SemSolver::IO::TextTokenizer::~TextTokenizer()
+{
+    if(mapped)
+        qobject_cast<QFile *>(device)->unmap(mapped);
+}
+
+bool SemSolver::IO::TextTokenizer::nextLine()
+{
+    tokens.clear();
+    while(position<end)
+    {
+        char const *p = position;
+        while(p<end && *p!='\n' && *p!='#')
+        {
+            if(is_space(*p))
+            {
+                ++p;
+                continue;
+            }
+            Token token;
+            token.begin = p;
+            while(p<end && !is_space(*p) && *p!='#')
+                ++p;
+            token.end = p;
+            tokens.push_back(token);
+        }
+        if(p<end && *p=='#')
+        {
+            p = (char const *)memchr(p, '\n', end-p);
+            if(!p)
+                p = end;
+        }
+        position = p<end ? p+1 : end;
+        if(!tokens.empty())
+            return true;
+    }
+    return false;
+}
+
+int SemSolver::IO::TextTokenizer::toInt(int const &i, bool *ok) const
+{
+    int value = 0;
+    bool parsed = i>=0 && i<size() && parse_int(tokens[i].begin, tokens[i].end, value);
+    if(ok)
+        *ok = parsed;
+    return parsed ? value : 0;
+}
+
+double SemSolver::IO::TextTokenizer::toDouble(int const &i, bool *ok) const
+{
+    double value = 0.;
+    bool parsed = i>=0 && i<size() && parse_double(tokens[i].begin, tokens[i].end, value);
+    if(ok)
+        *ok = parsed;
+    return parsed ? value : 0.;
+}
+
+bool SemSolver::IO::TextTokenizer::nextToken(Token &token)
+{
+    while(position<end && is_space(*position))
+        ++position;
+    if(position==end)
+        return false;
+    token.begin = position;
+    while(position<end && !is_space(*position))
+        ++position;
+    token.end = position;
+    return true;
+}
+
+bool SemSolver::IO::TextTokenizer::next(int &value)
+{
+    Token token;
+    return nextToken(token) && parse_int(token.begin, token.end, value);
+}
+
+bool SemSolver::IO::TextTokenizer::next(double &value)
+{
+    Token token;
+    return nextToken(token) && parse_double(token.begin, token.end, value);
+}
+
+bool SemSolver::IO::parse_int(char const *begin, char const *end, int &value)
+{
+    char const *p = begin;
+    bool negative = false;
+    if(p<end && (*p=='+' || *p=='-'))
+        negative = (*p++=='-');
+    if(p==end)
+        return false;
+    qint64 result = 0;
+    for(; p<end; ++p)
+    {
+        if(*p<'0' || *p>'9')
+            return false;
+        result = result*10 + (*p-'0');
+        if(result > (qint64)2147483647 + negative)
+            return false;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+bool SemSolver::IO::parse_double(char const *begin, char const *end, double &value)
+{
+    // powers of ten exactly representable as doubles
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+    char const *p = begin;
+    bool negative = false;
+    if(p<end && (*p=='+' || *p=='-'))
+        negative = (*p++=='-');
+    quint64 mantissa = 0;
+    int exponent = 0;
+    char const *digits = p;
+    for(; p<end && (unsigned char)(*p-'0')<10; ++p)
+        mantissa = mantissa*10 + (*p-'0');
+    int count = p-digits;
+    if(p<end && *p=='.')
+    {
+        digits = ++p;
+        for(; p<end && (unsigned char)(*p-'0')<10; ++p)
+            mantissa = mantissa*10 + (*p-'0');
+        exponent = digits-p;
+        count += p-digits;
+    }
+    if(count && p<end && (*p=='e' || *p=='E'))
+    {
+        ++p;
+        bool negative_exponent = false;
+        if(p<end && (*p=='+' || *p=='-'))
+            negative_exponent = (*p++=='-');
+        if(p==end || (unsigned char)(*p-'0')>=10)
+            count = 0;
+        int e = 0;
+        for(; p<end && (unsigned char)(*p-'0')<10; ++p)
+            if(e<100000)
+                e = e*10 + (*p-'0');
+        exponent += negative_exponent ? -e : e;
+    }
+    // exact when both mantissa and power of ten are exact doubles, digits beyond
+    // the 19th may have overflowed mantissa
+    if(count && count<=19 && p==end && mantissa<=((quint64)1<<53)
+       && exponent>=-22 && exponent<=22)
+    {
+        value = (double)mantissa;
+        value = exponent<0 ? value/powers[-exponent] : value*powers[exponent];
+        if(negative)
+            value = -value;
+        return true;
+    }
+    // long mantissas, large exponents, inf and nan
+    bool ok;
+    value = QByteArray::fromRawData(begin, end-begin).toDouble(&ok);
+    return ok;
+}
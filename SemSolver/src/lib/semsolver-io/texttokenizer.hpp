@@ -0,0 +1,89 @@
+#ifndef IO_TEXTTOKENIZER_HPP
+#define IO_TEXTTOKENIZER_HPP
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <vector>
+
+namespace SemSolver
+{
+    //! Namespace for Input/Output operations on SemSolver Classes
+    namespace IO
+    {
+        //! Class for splitting text in whitespace separated tokens
+        /*! Data of memory mapped files and of buffers is accessed in place, tokens are
+            never copied. Numbers are parsed directly from the characters, with an exact
+            fast path for decimals of at most 19 significant digits and exponents
+            within 22, which covers nearly all input files. */
+        class TextTokenizer
+        {
+            //! Position of a token in data
+            struct Token
+            {
+                char const *begin; //!< First character
+                char const *end;   //!< Character after the last one
+            };
+
+            QIODevice          *device;
+            uchar              *mapped;
+            QByteArray         memory;
+            char const         *position;
+            char const         *end;
+            std::vector<Token> tokens;
+
+        public:
+            //! Constructor of a tokenizer over an open device
+            /*! Files are memory mapped and buffers accessed in place, other devices are
+                read into memory */
+            //! \param device Device to be tokenized, must be open
+            TextTokenizer(QIODevice *device);
+
+            //! Constructor of a tokenizer over a memory range
+            TextTokenizer(char const *begin, char const *end);
+
+            //! Destructor, releases file mapping
+            ~TextTokenizer();
+
+            //! Split next line with values skipping empty lines and comments
+            //! \return false if there are no more values
+            bool nextLine();
+
+            //! Get number of values on current line
+            inline int size() const
+            {
+                return tokens.size();
+            };
+
+            //! Test if current line has no values
+            inline bool isEmpty() const
+            {
+                return tokens.empty();
+            };
+
+            //! Get i-th value on current line as an integer
+            int toInt(int const &i, bool *ok = 0) const;
+
+            //! Get i-th value on current line as a double
+            double toDouble(int const &i, bool *ok = 0) const;
+
+            //! Get next value as an integer regardless of lines
+            bool next(int &value);
+
+            //! Get next value as a double regardless of lines
+            bool next(double &value);
+
+        private:
+            //! Get next token regardless of lines
+            bool nextToken(Token &token);
+        };
+
+        //! Parse an integer from characters
+        bool parse_int(char const *begin, char const *end, int &value);
+
+        //! Parse a double from characters
+        bool parse_double(char const *begin, char const *end, double &value);
+    };
+};
+
+#endif // IO_TEXTTOKENIZER_HPP
@@ -1,7 +1,21 @@
 #include "workspace.hpp"
 #include "archive.hpp"
 
-#include <QTemporaryFile>
+#include <QByteArray>
+#include <QList>
+
+//! zlib level of entries added to workspaces, 0 to store them as plain files
+static int compression_level = 0;
+
+void SemSolver::IO::set_workspace_compression_level(int const &level)
+{
+    compression_level = level;
+};
+
+int SemSolver::IO::workspace_compression_level()
+{
+    return compression_level;
+};
 
 bool SemSolver::IO::get_geometries_list_from_workspace(QFile *file,
                                                    QStringList &geometries)
@@ -92,45 +106,78 @@ bool SemSolver::IO::extract_file_from_workspace(QFile *workspace,
     return true;
 };
 
-bool SemSolver::IO::add_file_to_workspace(QFile *workspace,
-                                       const QString &name,
-                                       QFile *file)
+//! Read all entries of a workspace but one into memory
+/*! Data is read as stored, so that compressed entries are not decompressed, and it is
+    detached from the archive mapping since the workspace is going to be rewritten */
+static bool read_other_entries(SemSolver::IO::Archive &archive,
+                               const QString &name,
+                               QStringList &list,
+                               QList<QByteArray> &data)
 {
-    if(!workspace->exists() || !file->exists())
-        return false;
-    Archive archive(workspace);
     if(!archive.openRead())
         return false;
-    QStringList list = archive.entries();
+    list = archive.entries();
     list.removeAll(name);
-    QTemporaryFile *temp_files = new QTemporaryFile[list.size()];
     for (int i=0; i<list.size(); ++i)
     {
-        if(!archive.extractFile(list[i], temp_files+i))
+        QByteArray entry;
+        if(!archive.storedEntryData(list[i], entry))
         {
-            delete[] temp_files;
+            archive.closeRead();
             return false;
         }
+        entry.detach();
+        data.push_back(entry);
     }
-    if(!archive.closeRead())
-    {
-        delete[] temp_files;
-        return false;
-    }
-    if(!archive.openWrite())
-    {
-        delete[] temp_files;
-        return false;
-    }
+    return archive.closeRead();
+};
+
+//! Write entries to a workspace
+static bool write_entries(SemSolver::IO::Archive &archive,
+                          const QStringList &list,
+                          const QList<QByteArray> &data)
+{
     for (int i=0; i<list.size(); ++i)
+        if(!archive.addData(data[i], list[i]))
+            return false;
+    return true;
+};
+
+//! Test if a workspace has enough overridden or removed entries to be compacted
+static bool needs_compaction(const SemSolver::IO::Archive &archive)
+{
+    return archive.wastedSize() > archive.usedSize()/2;
+};
+
+bool SemSolver::IO::add_file_to_workspace(QFile *workspace,
+                                       const QString &name,
+                                       QFile *file)
+{
+    if(!workspace->exists() || !file->exists())
+        return false;
+    Archive archive(workspace);
+    archive.setCompressionLevel(compression_level);
+    if(archive.openAppend())
     {
-        if(!archive.addFile(temp_files+i, list[i]))
+        if(!archive.addFile(file, name))
         {
-            delete[] temp_files;
+            archive.closeAppend();
             return false;
         }
+        bool compact = needs_compaction(archive);
+        if(!archive.closeAppend())
+            return false;
+        return !compact || compact_workspace(workspace);
     }
-    delete[] temp_files;
+    // archives which cannot be appended are rewritten
+    QStringList list;
+    QList<QByteArray> data;
+    if(!read_other_entries(archive, name, list, data))
+        return false;
+    if(!archive.openWrite())
+        return false;
+    if(!write_entries(archive, list, data))
+        return false;
     if(!archive.addFile(file, name))
         return false;
     if(!archive.closeWrite())
@@ -144,39 +191,233 @@ bool SemSolver::IO::remove_file_from_workspace(QFile *workspace,
     if(!workspace->exists())
         return false;
     Archive archive(workspace);
-    if(!archive.openRead())
-        return false;
-    QStringList list = archive.entries();
-    list.removeAll(name);
-    QTemporaryFile *temp_files = new QTemporaryFile[list.size()];
-    for (int i=0; i<list.size(); ++i)
+    if(archive.openAppend())
     {
-        if(!archive.extractFile(list[i], temp_files+i))
+        if(!archive.removeEntry(name))
         {
-            delete[] temp_files;
+            archive.closeAppend();
             return false;
         }
+        bool compact = needs_compaction(archive);
+        if(!archive.closeAppend())
+            return false;
+        return !compact || compact_workspace(workspace);
     }
-    if(!archive.closeRead())
-    {
-        delete[] temp_files;
+    // archives which cannot be appended are rewritten
+    return compact_workspace(workspace, name);
+};
+
+bool SemSolver::IO::compact_workspace(QFile *workspace,
+                                      const QString &removed)
+{
+    if(!workspace->exists())
+        return false;
+    Archive archive(workspace);
+    archive.setCompressionLevel(compression_level);
+    QStringList list;
+    QList<QByteArray> data;
+    if(!read_other_entries(archive, removed, list, data))
         return false;
-    }
     if(!archive.openWrite())
+        return false;
+    if(!write_entries(archive, list, data))
+        return false;
+    if(!archive.closeWrite())
+        return false;
+    return true;
+};
+
+//! Kind of files cached in a workspace
+struct CacheKind
+{
+    const char *list;      //!< Name of the list of cached files
+    const char *directory; //!< Directory of cached files entries
+    const char *extension; //!< Extension of cached files entries
+};
+
+//! Cached solutions
+static const CacheKind solution_cache = { "solutions.semcache", "solutions/",
+                                          ".semsln" };
+
+//! Cached subdomains
+static const CacheKind subdomains_cache = { "subdomains.semcache", "subdomains/",
+                                            ".semsub" };
+
+//! Record of a cached file
+struct CachedFile
+{
+    QByteArray hash; //!< Hexadecimal hash of the inputs
+    qint64     size; //!< Size of the file
+    qint64     use;  //!< Order of last use, larger is more recent
+};
+
+//! Get name of the entry of a cached file
+static QString cached_file_name(const CacheKind &kind, const QByteArray &hash)
+{
+    return kind.directory + QString::fromLatin1(hash.toHex()) + kind.extension;
+};
+
+//! Read list of cached files, made of "<hash> <size> <use>" lines
+static QList<CachedFile> read_cache_list(const CacheKind &kind,
+                                         SemSolver::IO::Archive &archive)
+{
+    QList<CachedFile> list;
+    QByteArray data;
+    if(!archive.entryData(kind.list, data))
+        return list;
+    QList<QByteArray> lines = data.split('\n');
+    for(int i=0; i<lines.size(); ++i)
+    {
+        QList<QByteArray> fields = lines[i].split(' ');
+        if(fields.size()!=3)
+            continue;
+        CachedFile file;
+        bool size_ok, use_ok;
+        file.hash = fields[0];
+        file.size = fields[1].toLongLong(&size_ok);
+        file.use = fields[2].toLongLong(&use_ok);
+        if(size_ok && use_ok
+           && archive.contains(cached_file_name(kind, QByteArray::fromHex(file.hash))))
+            list.push_back(file);
+    }
+    return list;
+};
+
+//! Write list of cached files
+static QByteArray write_cache_list(const QList<CachedFile> &list)
+{
+    QByteArray data;
+    for(int i=0; i<list.size(); ++i)
+        data += list[i].hash + ' ' + QByteArray::number(list[i].size) + ' '
+                + QByteArray::number(list[i].use) + '\n';
+    return data;
+};
+
+//! Get the order of use following all the listed ones
+static qint64 next_use(const QList<CachedFile> &list)
+{
+    qint64 use = 0;
+    for(int i=0; i<list.size(); ++i)
+        use = qMax(use, list[i].use+1);
+    return use;
+};
+
+//! Get a file cached in workspace, marking it as the most recently used one
+static bool get_cached_file(const CacheKind &kind,
+                            QFile *workspace,
+                            const QByteArray &hash,
+                            QByteArray &data)
+{
+    if(!workspace->exists())
+        return false;
+    SemSolver::IO::Archive archive(workspace);
+    if(!archive.openRead())
+        return false;
+    QList<CachedFile> list = read_cache_list(kind, archive);
+    bool found = archive.entryData(cached_file_name(kind, hash), data);
+    data.detach();
+    archive.closeRead();
+    if(!found)
+        return false;
+
+    // mark file as the most recently used one, a failure only loses the order
+    QByteArray hex = hash.toHex();
+    qint64 use = next_use(list);
+    for(int i=0; i<list.size(); ++i)
+        if(list[i].hash==hex)
+            list[i].use = use;
+    if(archive.openAppend())
     {
-        delete[] temp_files;
+        archive.addData(write_cache_list(list), kind.list);
+        bool compact = needs_compaction(archive);
+        if(archive.closeAppend() && compact)
+            SemSolver::IO::compact_workspace(workspace);
+    }
+    return true;
+};
+
+//! Add a file to the cache of a workspace, evicting least recently used ones
+static bool add_cached_file(const CacheKind &kind,
+                            QFile *workspace,
+                            const QByteArray &hash,
+                            const QByteArray &data,
+                            qint64 const &capacity)
+{
+    if(!workspace->exists() || data.size()>capacity)
         return false;
+    SemSolver::IO::Archive archive(workspace);
+    archive.setCompressionLevel(compression_level);
+    QList<CachedFile> list;
+    if(archive.openRead())
+    {
+        list = read_cache_list(kind, archive);
+        archive.closeRead();
     }
-    for (int i=0; i<list.size(); ++i)
+
+    // evict least recently used files
+    QByteArray hex = hash.toHex();
+    qint64 size = data.size();
+    for(int i=list.size()-1; i>=0; --i)
+        if(list[i].hash==hex)
+            list.removeAt(i);
+    for(int i=0; i<list.size(); ++i)
+        size += list[i].size;
+    QList<CachedFile> evicted;
+    while(size>capacity && !list.isEmpty())
     {
-        if(!archive.addFile(temp_files+i, list[i]))
-        {
-            delete[] temp_files;
-            return false;
-        }
+        int oldest = 0;
+        for(int i=1; i<list.size(); ++i)
+            if(list[i].use<list[oldest].use)
+                oldest = i;
+        size -= list[oldest].size;
+        evicted.push_back(list.takeAt(oldest));
     }
-    delete[] temp_files;
-    if(!archive.closeWrite())
+    CachedFile file;
+    file.hash = hex;
+    file.size = data.size();
+    file.use = next_use(list);
+    list.push_back(file);
+
+    // only appendable workspaces are used as caches
+    if(!archive.openAppend())
         return false;
-    return true;
+    bool ok = archive.addData(data, cached_file_name(kind, hash));
+    for(int i=0; ok && i<evicted.size(); ++i)
+        ok = archive.removeEntry(
+                cached_file_name(kind, QByteArray::fromHex(evicted[i].hash)));
+    ok = ok && archive.addData(write_cache_list(list), kind.list);
+    bool compact = needs_compaction(archive);
+    if(!archive.closeAppend() || !ok)
+        return false;
+    return !compact || SemSolver::IO::compact_workspace(workspace);
+};
+
+bool SemSolver::IO::get_cached_solution_from_workspace(QFile *workspace,
+                                                       const QByteArray &hash,
+                                                       QByteArray &data)
+{
+    return get_cached_file(solution_cache, workspace, hash, data);
+};
+
+bool SemSolver::IO::add_cached_solution_to_workspace(QFile *workspace,
+                                                     const QByteArray &hash,
+                                                     const QByteArray &data,
+                                                     qint64 const &capacity)
+{
+    return add_cached_file(solution_cache, workspace, hash, data, capacity);
+};
+
+bool SemSolver::IO::get_cached_subdomains_from_workspace(QFile *workspace,
+                                                         const QByteArray &hash,
+                                                         QByteArray &data)
+{
+    return get_cached_file(subdomains_cache, workspace, hash, data);
+};
+
+bool SemSolver::IO::add_cached_subdomains_to_workspace(QFile *workspace,
+                                                       const QByteArray &hash,
+                                                       const QByteArray &data,
+                                                       qint64 const &capacity)
+{
+    return add_cached_file(subdomains_cache, workspace, hash, data, capacity);
 };
@@ -0,0 +1,350 @@
+#ifndef IO_WORKSPACELOADER_HPP
+#define IO_WORKSPACELOADER_HPP
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QFile>
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <QtConcurrentRun>
+
+#include <SemSolver/semgeometry.hpp>
+#include <SemSolver/equation.hpp>
+#include <SemSolver/boundaryconditions.hpp>
+#include <SemSolver/semparameters.hpp>
+
+#include  <SemSolver/IO/archive.hpp>
+#include  <SemSolver/IO/geometry.hpp>
+#include  <SemSolver/IO/equation.hpp>
+#include  <SemSolver/IO/boundaryconditions.hpp>
+#include  <SemSolver/IO/parameters.hpp>
+
+namespace SemSolver
+{
+    //! Namespace for Input/Output operations on SemSolver Classes
+    namespace IO
+    {
+        //! Class for loading the components of a workspace at once
+        /*! The workspace archive is opened once for listing and reading components.
+            Entries are taken from its memory mapping. Geometry and parameters are
+            parsed on the global thread pool, while equation and boundary conditions are
+            parsed in the calling thread, so that the Polygonation of the geometry is
+            built in parallel with the ScriptFunction objects and their QScriptEngine
+            objects belong to the calling thread. Each component reports its own error,
+            as the get_*_from_workspace functions do. Loaded functions must be used by
+            one thread at a time. */
+        template<class X>
+        class WorkspaceLoader
+        {
+            //! Functor parsing a geometry entry
+            struct ReadGeometry
+            {
+                typedef bool result_type;
+
+                QByteArray data;
+                SemGeometry<2, X> *geometry;
+
+                bool operator()() const
+                {
+                    return read_geometry(data, *geometry);
+                };
+            };
+
+            //! Functor parsing an equation entry
+            struct ReadEquation
+            {
+                typedef bool result_type;
+
+                QByteArray data;
+                Equation<2, X> **equation;
+
+                bool operator()() const
+                {
+                    QBuffer buffer;
+                    buffer.setData(data);
+                    return read_equation(&buffer, *equation);
+                };
+            };
+
+            //! Functor parsing a boundary conditions entry
+            struct ReadBoundaryConditions
+            {
+                typedef bool result_type;
+
+                QByteArray data;
+                BoundaryConditions<2, X> *boundary_conditions;
+
+                bool operator()() const
+                {
+                    QBuffer buffer;
+                    buffer.setData(data);
+                    return read_boundary_conditions(&buffer, *boundary_conditions);
+                };
+            };
+
+            //! Functor parsing a parameters entry
+            struct ReadParameters
+            {
+                typedef bool result_type;
+
+                QByteArray data;
+                SemParameters<X> *parameters;
+
+                bool operator()() const
+                {
+                    QBuffer buffer;
+                    buffer.setData(data);
+                    return read_parameters(&buffer, *parameters);
+                };
+            };
+
+            Archive                  archive;
+            bool                     opened;
+            QStringList              _geometries;
+            QStringList              _equations;
+            QStringList              _boundary_conditions_list;
+            QStringList              _parameters_list;
+            SemGeometry<2, X>        _geometry;
+            Equation<2, X>           *_equation;
+            BoundaryConditions<2, X> _boundary_conditions;
+            SemParameters<X>         _parameters;
+            bool                     geometry_loaded;
+            bool                     equation_loaded;
+            bool                     boundary_conditions_loaded;
+            bool                     parameters_loaded;
+
+            //! Get names of entries with an extension, without extension
+            static QStringList components(QStringList const &entries,
+                                          QString const &extension);
+
+        public:
+            //! Default constructor
+            //! file pointer to workspace file
+            WorkspaceLoader(QFile *file);
+
+            //! Destructor, closes the workspace and frees an equation not taken
+            ~WorkspaceLoader();
+
+            //! Open workspace and list its components
+            bool open();
+
+            //! Close workspace
+            void close();
+
+            //! Get names of geometries in workspace
+            inline QStringList const &geometries() const
+            {
+                return _geometries;
+            };
+
+            //! Get names of equations in workspace
+            inline QStringList const &equations() const
+            {
+                return _equations;
+            };
+
+            //! Get names of boundary conditions in workspace
+            inline QStringList const &boundaryConditionsList() const
+            {
+                return _boundary_conditions_list;
+            };
+
+            //! Get names of parameters in workspace
+            inline QStringList const &parametersList() const
+            {
+                return _parameters_list;
+            };
+
+            //! Load components concurrently
+            /*! Components with an empty name are not loaded */
+            //! \return false if any requested component could not be loaded
+            bool load(QString const &geometry,
+                      QString const &equation,
+                      QString const &boundary_conditions,
+                      QString const &parameters);
+
+            //! Test if geometry was loaded
+            inline bool geometryLoaded() const
+            {
+                return geometry_loaded;
+            };
+
+            //! Test if equation was loaded
+            inline bool equationLoaded() const
+            {
+                return equation_loaded;
+            };
+
+            //! Test if boundary conditions were loaded
+            inline bool boundaryConditionsLoaded() const
+            {
+                return boundary_conditions_loaded;
+            };
+
+            //! Test if parameters were loaded
+            inline bool parametersLoaded() const
+            {
+                return parameters_loaded;
+            };
+
+            //! Get loaded geometry
+            inline SemGeometry<2, X> const &geometry() const
+            {
+                return _geometry;
+            };
+
+            //! Take loaded equation, the caller becomes its owner
+            inline Equation<2, X> *takeEquation()
+            {
+                Equation<2, X> *equation = _equation;
+                _equation = 0;
+                equation_loaded = false;
+                return equation;
+            };
+
+            //! Get loaded boundary conditions
+            inline BoundaryConditions<2, X> const &boundaryConditions() const
+            {
+                return _boundary_conditions;
+            };
+
+            //! Get loaded parameters
+            inline SemParameters<X> const &parameters() const
+            {
+                return _parameters;
+            };
+        };
+    };
+};
+
+template<class X>
+SemSolver::IO::WorkspaceLoader<X>::WorkspaceLoader(QFile *file)
+    : archive(file)
+{
+    opened = false;
+    _equation = 0;
+    geometry_loaded = false;
+    equation_loaded = false;
+    boundary_conditions_loaded = false;
+    parameters_loaded = false;
+};
+
+template<class X>
+SemSolver::IO::WorkspaceLoader<X>::~WorkspaceLoader()
+{
+    close();
+    delete _equation;
+};
+
+template<class X>
+QStringList SemSolver::IO::WorkspaceLoader<X>::components(QStringList const &entries,
+                                                          QString const &extension)
+{
+    QStringList names;
+    for (QStringList::const_iterator it=entries.begin(); it!=entries.end(); ++it)
+        if (it->endsWith(extension))
+            names.push_back(it->section(".",0,-2));
+    return names;
+};
+
+template<class X>
+bool SemSolver::IO::WorkspaceLoader<X>::open()
+{
+    if(opened)
+        return true;
+    if(!archive.openRead())
+        return false;
+    opened = true;
+    QStringList entries = archive.entries();
+    _geometries = components(entries, ".semgeo");
+    _equations = components(entries, ".semeqn");
+    _boundary_conditions_list = components(entries, ".sembcs");
+    _parameters_list = components(entries, ".semprm");
+    return true;
+};
+
+template<class X>
+void SemSolver::IO::WorkspaceLoader<X>::close()
+{
+    if(opened)
+        archive.closeRead();
+    opened = false;
+};
+
+template<class X>
+bool SemSolver::IO::WorkspaceLoader<X>::load(QString const &geometry,
+                                             QString const &equation,
+                                             QString const &boundary_conditions,
+                                             QString const &parameters)
+{
+    if(!open())
+        return false;
+    delete _equation;
+    _equation = 0;
+    geometry_loaded = false;
+    equation_loaded = false;
+    boundary_conditions_loaded = false;
+    parameters_loaded = false;
+
+    // entries are taken in this thread, since decompressing them updates the archive
+    QFuture<bool> geometry_future, parameters_future;
+    bool geometry_started = false, parameters_started = false;
+    if(!geometry.isEmpty())
+    {
+        ReadGeometry read;
+        read.geometry = &_geometry;
+        if(archive.entryData(geometry + ".semgeo", read.data))
+        {
+            geometry_future = QtConcurrent::run(read);
+            geometry_started = true;
+        }
+    }
+    if(!parameters.isEmpty())
+    {
+        ReadParameters read;
+        read.parameters = &_parameters;
+        if(archive.entryData(parameters + ".semprm", read.data))
+        {
+            parameters_future = QtConcurrent::run(read);
+            parameters_started = true;
+        }
+    }
+
+    // script functions are built in this thread, as their QScriptEngine objects must
+    // belong to the thread which uses them
+    if(!equation.isEmpty())
+    {
+        ReadEquation read;
+        read.equation = &_equation;
+        equation_loaded = archive.entryData(equation + ".semeqn", read.data) && read();
+    }
+    if(!boundary_conditions.isEmpty())
+    {
+        ReadBoundaryConditions read;
+        read.boundary_conditions = &_boundary_conditions;
+        boundary_conditions_loaded =
+                archive.entryData(boundary_conditions + ".sembcs", read.data) && read();
+    }
+
+    // result waits for the task to finish
+    geometry_loaded = geometry_started && geometry_future.result();
+    parameters_loaded = parameters_started && parameters_future.result();
+#ifdef SEMDEBUG
+    if(!geometry.isEmpty() && !geometry_loaded)
+        qWarning("SemSolver::IO::WorkspaceLoader::load - ERROR : cannot load geometry.");
+    if(!equation.isEmpty() && !equation_loaded)
+        qWarning("SemSolver::IO::WorkspaceLoader::load - ERROR : cannot load equation.");
+    if(!boundary_conditions.isEmpty() && !boundary_conditions_loaded)
+        qWarning("SemSolver::IO::WorkspaceLoader::load - ERROR : cannot load boundary co"\
+                 "nditions.");
+    if(!parameters.isEmpty() && !parameters_loaded)
+        qWarning("SemSolver::IO::WorkspaceLoader::load - ERROR : cannot load parameters.");
+#endif
+    return (geometry.isEmpty() || geometry_loaded)
+            && (equation.isEmpty() || equation_loaded)
+            && (boundary_conditions.isEmpty() || boundary_conditions_loaded)
+            && (parameters.isEmpty() || parameters_loaded);
+};
+
+#endif // IO_WORKSPACELOADER_HPP
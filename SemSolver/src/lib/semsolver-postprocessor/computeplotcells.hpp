@@ -0,0 +1,43 @@
+#ifndef COMPUTEPLOTCELLS_HPP
+#define COMPUTEPLOTCELLS_HPP
+
+#include <SemSolver/semspace.hpp>
+
+namespace SemSolver
+{
+    namespace PostProcessor
+    {
+        //! Get number of plot cells of a space
+        /*! Each subdomain of degree N is split in N^2 quadrilaterals joining
+            neighbouring GLL nodes */
+        template<class X>
+        int compute_plot_cells_number(const SemSpace<2, X> &space)
+        {
+            int cells = 0;
+            for(int i=0; i<space.subDomains(); ++i)
+                cells += space.degree(i)*space.degree(i);
+            return cells;
+        };
+
+        //! Compute node indices of a plot cell
+        //! \param space Space of the plotted function
+        //! \param element Index of the subdomain
+        //! \param j First local index of the cell, less than subdomain degree
+        //! \param k Second local index of the cell, less than subdomain degree
+        //! \param cell Array where to store the four node indices, counterclockwise
+        template<class X>
+        void compute_plot_cell(const SemSpace<2, X> &space,
+                               int const &element,
+                               int const &j,
+                               int const &k,
+                               int cell[4])
+        {
+            cell[0] = space.subDomainIndex(element, j, k);
+            cell[1] = space.subDomainIndex(element, j+1, k);
+            cell[2] = space.subDomainIndex(element, j+1, k+1);
+            cell[3] = space.subDomainIndex(element, j, k+1);
+        };
+    };
+};
+
+#endif // COMPUTEPLOTCELLS_HPP
@@ -1,6 +1,8 @@
 TEMPLATE = subdirs
 HEADERS += buildsolution.hpp \
     computeplotdata.hpp \
+    computeplotcells.hpp \
+    computeerrorindicators.hpp \
     computesolutionhull.hpp
 
 
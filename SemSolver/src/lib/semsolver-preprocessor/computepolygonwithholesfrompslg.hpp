@@ -1,6 +1,11 @@
 #ifndef COMPUTEPOLYGONWITHHOLESFROMPSLG_HPP
 #define COMPUTEPOLYGONWITHHOLESFROMPSLG_HPP
 
+#include <QHash>
+
+#include <vector>
+
+#include <CGAL/Bbox_2.h>
 #include <SemSolver/polygonwithholes.hpp>
 #include <SemSolver/pslg.hpp>
 #include <SemSolver/sequenceslist.hpp>
@@ -12,122 +17,105 @@ namespace SemSolver
         associated to the problem from geometric information stored in PSLG format. */
     namespace PreProcessor
     {
-        //! Get sequences of vertices representing the set of polygons given by a PSLG
+        /*! Get sequences of vertices representing the set of polygons given by a PSLG.
+            Segments incident to each vertex are stored in a hash table, then each
+            boundary is walked from one of its segments to the next one through their
+            common vertex, so that time and memory are linear in the number of segments.
+            Closed boundaries give sequences whose first and last vertices coincide. */
+        //! \return false if more than two segments pass through a vertex
         template<class X>
         bool compute_vertices_sequences_from_pslg(PSLG<X> const &pslg,
                                                   Sequences_list &vertices_sequences)
         {
-            for(unsigned i=0; i<pslg.segments(); ++i)
+            unsigned n = pslg.segments();
+            QHash<int,int> slots;
+            slots.reserve(2*n);
+            std::vector<int> incident;
+            incident.reserve(4*n);
+            for(unsigned i=0; i<n; ++i)
             {
-                bool segment_added = false;
-                for(Sequences_list::iterator it = vertices_sequences.begin();
-                it!=vertices_sequences.end() && !segment_added;
-                ++it)
+                int ends[2] = {pslg.segment(i).source, pslg.segment(i).target};
+                for(int k=0; k<2; ++k)
                 {
-                    if(pslg.segment(i).source==it->back())
+                    QHash<int,int>::iterator slot = slots.find(ends[k]);
+                    if(slot==slots.end())
                     {
-                        it->push_back(pslg.segment(i).target);
-                        segment_added = true;
+                        slot = slots.insert(ends[k], incident.size()/2);
+                        incident.push_back(-1);
+                        incident.push_back(-1);
                     }
-                    else if(pslg.segment(i).target==it->back())
+                    int first = 2*slot.value();
+                    if(incident[first]<0)
+                        incident[first] = i;
+                    else if(incident[first+1]<0)
+                        incident[first+1] = i;
+                    else
                     {
-                        it->push_back(pslg.segment(i).source);
-                        segment_added = true;
+#ifdef SEMDEBUG
+                        qWarning("PSLG::to_polygon : no more than two segments must pass through each vertex");
+#endif
+                        return false;
                     }
                 }
-                if(!segment_added)
-                {
-                    Sequence sequence;
-                    sequence.push_back(pslg.segment(i).source);
-                    sequence.push_back(pslg.segment(i).target);
-                    vertices_sequences.push_back(sequence);
-                }
             }
-            Sequences_list::iterator begin = vertices_sequences.begin();
-            Sequences_list::iterator end = vertices_sequences.end();
-            Sequences_list::iterator before_end = --vertices_sequences.end();
-            for(Sequences_list::iterator it_0 = begin; it_0!=before_end && it_0 !=end;
-                ++it_0)
+            std::vector<bool> is_used_segment(n, false);
+            for(unsigned i=0; i<n; ++i)
             {
-                bool is_closed = (it_0->front()==it_0->back());
-                if(!is_closed)
+                if(is_used_segment[i])
+                    continue;
+                is_used_segment[i] = true;
+                Sequence sequence;
+                sequence.push_back(pslg.segment(i).source);
+                sequence.push_back(pslg.segment(i).target);
+                // walk forward from the target, then backward from the source if open
+                for(int backward=0; backward<2; ++backward)
                 {
-                    Sequences_list::iterator after_it_0 = it_0; ++after_it_0;
-                    for(Sequences_list::iterator it_1 = after_it_0; it_1!=end &&
-                        !is_closed; ++it_1)
+                    int segment = i;
+                    while(sequence.front()!=sequence.back())
                     {
-                        if(it_0->back()==it_1->front())
-                        {
-                            for(Sequence::const_iterator it_2=it_1->begin();
-                            ++it_2!=it_1->end(); )
-                                it_0->push_back(*it_2);
-                            vertices_sequences.erase(it_1);
-                            end = vertices_sequences.end();
-                            is_closed = (it_0->front()==it_0->back());
-                            it_1 = it_0;
-                        }
-                        else if(it_0->back()==it_1->back())
-                        {
-                            for(Sequence::const_reverse_iterator it_2=it_1->rbegin();
-                            ++it_2!=it_1->rend(); )
-                                it_0->push_back(*it_2);
-                            vertices_sequences.erase(it_1);
-                            end = vertices_sequences.end();
-                            is_closed = (it_0->front()==it_0->back());
-                            it_1 = it_0;
-                        }
-                        else if(it_0->front()==it_1->back())
-                        {
-                            for(Sequence::const_reverse_iterator it_2=it_1->rbegin();
-                            ++it_2!=it_1->rend(); )
-                                it_0->push_front(*it_2);
-                            vertices_sequences.erase(it_1);
-                            end = vertices_sequences.end();
-                            is_closed = (it_0->front()==it_0->back());
-                            it_1 = it_0;
-                        }
-                        else if(it_0->front()==it_1->front())
-                        {
-                            for(Sequence::const_iterator it_2=it_1->begin();
-                            ++it_2!=it_1->end(); )
-                                it_0->push_front(*it_2);
-                            vertices_sequences.erase(it_1);
-                            end = vertices_sequences.end();
-                            is_closed = (it_0->front()==it_0->back());
-                            it_1 = it_0;
-                        }
+                        int vertex = backward ? sequence.front() : sequence.back();
+                        int first = 2*slots.value(vertex);
+                        int next = incident[first]==segment ? incident[first+1]
+                                                            : incident[first];
+                        if(next<0 || is_used_segment[next])
+                            break;
+                        is_used_segment[next] = true;
+                        int other = pslg.segment(next).source==vertex ? pslg.segment(next).target
+                                                                      : pslg.segment(next).source;
+                        if(backward)
+                            sequence.push_front(other);
+                        else
+                            sequence.push_back(other);
+                        segment = next;
                     }
                 }
-                before_end = --vertices_sequences.end();
+                vertices_sequences.push_back(sequence);
             }
             return true;
         }
 
-        //! Compute the polygon with holes given by a PSLG
+        /*! Compute the polygon with holes given by a PSLG. The outer boundary is the
+            polygon of largest area, each hole point is tested only against the
+            polygons whose bounding box contains it. */
         template<class X>
         bool compute_polygon_with_holes_from_pslg(PSLG<X> const &pslg,
                                                   PolygonWithHoles<2,X> &polygon)
         {
-            typedef std::list< Polygon<2,X> > Polygons_list;
-            typedef typename Polygons_list::iterator Polygon_iterator;
-            typedef typename Polygons_list::const_iterator Polygon_const_iterator;
-
-            typedef std::map<int,int> Vertices_map;
-            typedef typename Polygon<2,X>::Vertex_const_iterator Vertex_const_iterator;
+            typedef QHash<int,int> Vertices_map;
 
             polygon.clear();
             Sequences_list vertices_sequences;
-            compute_vertices_sequences_from_pslg(pslg,vertices_sequences);
+            if(!compute_vertices_sequences_from_pslg(pslg,vertices_sequences))
+                return false;
             if(vertices_sequences.size()<1)
                 return false;
-            bool *is_used_vertex = new bool[pslg.vertices()];
+            std::vector<bool> is_used_vertex(pslg.vertices(), false);
             Vertices_map vertices_map;
+            vertices_map.reserve(pslg.vertices());
             for(unsigned i=0; i<pslg.vertices(); ++i)
-            {
-                is_used_vertex[i] = false;
-                vertices_map.insert(Vertices_map::value_type(pslg.vertex(i).number,i));
-            }
-            Polygons_list polygons;
+                vertices_map.insert(pslg.vertex(i).number,i);
+            std::vector< Polygon<2,X> > polygons;
+            polygons.reserve(vertices_sequences.size());
             for(Sequences_list::const_iterator it_0=vertices_sequences.begin();
             it_0!=vertices_sequences.end(); ++it_0)
             {
@@ -138,25 +126,21 @@ namespace SemSolver
                     return false;
                 }
 #endif
-                Polygon<2,X> subpolygon;
+                polygons.push_back(Polygon<2,X>());
+                Polygon<2,X> &subpolygon = polygons.back();
                 for(Sequence::const_iterator it_1=it_0->begin(); it_1!=--it_0->end(); ++it_1)
                 {
+                    int index = vertices_map.value(*it_1);
 #ifdef SEMDEBUG
-                    if(is_used_vertex[vertices_map[*it_1]])
+                    if(is_used_vertex[index])
                     {
                         qWarning("PSLG::to_polygon : no more than two segments must pass through each vertex");
                         return false;
                     }
-                    else
-                    {
-#endif
-                        double const &x = pslg.vertex(vertices_map[*it_1]).x;
-                        double const &y = pslg.vertex(vertices_map[*it_1]).y;
-                        subpolygon.push_back(Point<2,X>(x,y));
-                        is_used_vertex[vertices_map[*it_1]] = true;
-#ifdef SEMDEBUG
-                    }
 #endif
+                    subpolygon.push_back(Point<2,X>(pslg.vertex(index).x,
+                                                    pslg.vertex(index).y));
+                    is_used_vertex[index] = true;
                 }
 #ifdef SEMDEBUG
                 if(subpolygon.is_empty())
@@ -170,7 +154,6 @@ namespace SemSolver
                     return false;
                 }
 #endif
-                polygons.push_back(subpolygon);
             }
 #ifdef SEMDEBUG
             for(unsigned i=0; i<pslg.vertices(); ++i)
@@ -182,60 +165,62 @@ namespace SemSolver
                 }
             }
 #endif
-            Polygon_iterator outer;
-            bool found = false;
-            for(Polygon_iterator it_0 = polygons.begin(); it_0!=polygons.end() && !found;
-            ++it_0)
+            // the outer boundary encloses every other polygon, so it has largest area
+            unsigned outer = 0;
+            X outer_area = X(0);
+            std::vector<CGAL::Bbox_2> boxes(polygons.size());
+            for(unsigned i=0; i<polygons.size(); ++i)
             {
-                bool is_outer = true;
-                for(Polygon_const_iterator it_1 = polygons.begin(); it_1!=polygons.end()
-                    &&is_outer; ++it_1)
-                    if(it_0!=it_1)
-                        for (Vertex_const_iterator it_2 = it_1->vertices_begin();
-                it_2 != it_1->vertices_end() &&is_outer; ++it_2)
-                            if(!it_0->has_on_bounded_side(*it_2))
-                                is_outer = false;
-                if(is_outer)
+                boxes[i] = polygons[i].bbox();
+                X area = polygons[i].area();
+                if(area<X(0))
+                    area = -area;
+                if(area>outer_area)
                 {
-                    outer = it_0;
-                    found = true;
+                    outer = i;
+                    outer_area = area;
                 }
             }
-            if(outer->is_clockwise_oriented())
-                outer->reverse_orientation();
-            polygon.outer_boundary() = *outer;
-            polygons.erase(outer);
+            if(polygons[outer].is_clockwise_oriented())
+                polygons[outer].reverse_orientation();
+            polygon.outer_boundary() = polygons[outer];
 #ifdef SEMDEBUG
-            if(polygons.size()<pslg.holes())
+            if(polygons.size()-1<pslg.holes())
             {
                 qWarning("PSLG::to_polygon : there are too many holes");
                 return false;
             }
-            if(polygons.size()>pslg.holes())
+            if(polygons.size()-1>pslg.holes())
             {
                 qWarning("PSLG::to_polygon : there are not enough holes");
                 return false;
             }
 #endif
+            std::vector<bool> is_used_polygon(polygons.size(), false);
+            is_used_polygon[outer] = true;
             for(unsigned i=0; i<pslg.holes(); ++i)
             {
-                Polygon_iterator it=polygons.begin();
-                Point<2,X> hole(pslg.hole(i).x,pslg.hole(i).y);
-#ifdef SEMDEBUG
-                while(!it->has_on_bounded_side(hole))
+                double x = pslg.hole(i).x;
+                double y = pslg.hole(i).y;
+                Point<2,X> hole(x,y);
+                unsigned j = 0;
+                while(j<polygons.size() &&
+                      (is_used_polygon[j] ||
+                       x<boxes[j].xmin() || x>boxes[j].xmax() ||
+                       y<boxes[j].ymin() || y>boxes[j].ymax() ||
+                       !polygons[j].has_on_bounded_side(hole)))
+                    ++j;
+                if(j==polygons.size())
                 {
-                    ++it;
-                    if(it==polygons.end())
-                    {
-                        qWarning("PSLG::to_polygon : there is no hole inside inner polygon");
-                        return false;
-                    }
-                }
+#ifdef SEMDEBUG
+                    qWarning("PSLG::to_polygon : there is no hole inside inner polygon");
 #endif
-                if(it->is_counterclockwise_oriented())
-                    it->reverse_orientation();
-                polygon.add_hole(*it);
-                polygons.erase(it);
+                    return false;
+                }
+                if(polygons[j].is_counterclockwise_oriented())
+                    polygons[j].reverse_orientation();
+                polygon.add_hole(polygons[j]);
+                is_used_polygon[j] = true;
             }
             return true;
         }
@@ -0,0 +1,456 @@
+#ifndef PARTITIONPOLYGONATION_HPP
+#define PARTITIONPOLYGONATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <SemSolver/polygonation.hpp>
+#include <SemSolver/semspace.hpp>
+
+namespace SemSolver
+{
+    //! \brief PreProcessor namespace
+    /*! This namespace provides algorithms for the constuction of the geometric structures
+        associated to the problem from geometric information stored in PSLG format. */
+    namespace PreProcessor
+    {
+        //! Weighted graph of the elements of a Polygonation
+        /*! Vertices are elements, edges join neighbour elements. It is stored in
+            compressed row storage: vertices adjacent to vertex i are adjacent[k] for k
+            from first[i] to first[i+1]-1, and edge_weights[k] are the weights of the
+            edges to them */
+        struct ElementGraph
+        {
+            std::vector<unsigned> first;
+            std::vector<unsigned> adjacent;
+            std::vector<int>      edge_weights;
+            std::vector<int>      vertex_weights;
+
+            //! Get number of vertices
+            inline unsigned size() const
+            {
+                return vertex_weights.size();
+            };
+        };
+
+        //! Compute the graph of the elements of a Polygonation
+        /*! Elements and shared edges have unit weight. Neighbour ids are made
+            symmetric, since on nonconforming edges only one of the halves is the
+            neighbour of the whole edge */
+        template<class X>
+        void compute_element_graph(Polygonation<2,X> const &polygonation,
+                                   ElementGraph &graph)
+        {
+            unsigned n = polygonation.size();
+            std::vector< std::vector<unsigned> > lists(n);
+            for(unsigned i=0; i<n; ++i)
+            {
+                typename Polygonation<2,X>::Element const &element = polygonation.element(i);
+                for(int j=0; j<element.size(); ++j)
+                {
+                    int id = element.neighbour(j);
+                    if(id<=0 || (unsigned)id-1==i) // border
+                        continue;
+                    lists[i].push_back(id-1);
+                    lists[id-1].push_back(i);
+                }
+            }
+            graph.first.assign(n+1, 0);
+            graph.adjacent.clear();
+            for(unsigned i=0; i<n; ++i)
+            {
+                std::sort(lists[i].begin(), lists[i].end());
+                lists[i].erase(std::unique(lists[i].begin(), lists[i].end()), lists[i].end());
+                graph.adjacent.insert(graph.adjacent.end(), lists[i].begin(), lists[i].end());
+                graph.first[i+1] = graph.adjacent.size();
+            }
+            graph.edge_weights.assign(graph.adjacent.size(), 1);
+            graph.vertex_weights.assign(n, 1);
+        };
+
+        //! Coarsen an element graph by heavy edge matching
+        /*! Each vertex is matched with the unmatched neighbour joined by the heaviest
+            edge, matched pairs are collapsed into one vertex summing weights, and edges
+            between pairs are merged summing weights. It costs O(E) operations */
+        //! \param graph The graph to coarsen
+        //! \param coarse Graph reference where to store the coarse graph
+        //! \param map Vector where to store the coarse vertex of each vertex
+        inline void coarsen_element_graph(ElementGraph const &graph,
+                                          ElementGraph &coarse,
+                                          std::vector<unsigned> &map)
+        {
+            unsigned n = graph.size();
+            std::vector<int> match(n, -1);
+            map.resize(n);
+            unsigned m = 0;
+            for(unsigned i=0; i<n; ++i)
+            {
+                if(match[i]>=0)
+                    continue;
+                int best = -1, weight = 0;
+                for(unsigned k=graph.first[i]; k<graph.first[i+1]; ++k)
+                {
+                    unsigned v = graph.adjacent[k];
+                    if(match[v]<0 && graph.edge_weights[k]>weight)
+                    {
+                        best = v;
+                        weight = graph.edge_weights[k];
+                    }
+                }
+                match[i] = best<0 ? (int)i : best;
+                map[i] = m;
+                if(best>=0)
+                {
+                    match[best] = i;
+                    map[best] = m;
+                }
+                ++m;
+            }
+
+            // members of each coarse vertex, counting sort on map
+            std::vector<unsigned> members_first(m+1, 0);
+            for(unsigned i=0; i<n; ++i)
+                ++members_first[map[i]+1];
+            for(unsigned c=0; c<m; ++c)
+                members_first[c+1] += members_first[c];
+            std::vector<unsigned> members(n);
+            {
+                std::vector<unsigned> fill(members_first.begin(), members_first.end()-1);
+                for(unsigned i=0; i<n; ++i)
+                    members[fill[map[i]]++] = i;
+            }
+
+            coarse.first.assign(m+1, 0);
+            coarse.adjacent.clear();
+            coarse.edge_weights.clear();
+            coarse.vertex_weights.assign(m, 0);
+            std::vector<int> position(m, -1);
+            for(unsigned c=0; c<m; ++c)
+            {
+                unsigned row = coarse.adjacent.size();
+                for(unsigned q=members_first[c]; q<members_first[c+1]; ++q)
+                {
+                    unsigned u = members[q];
+                    coarse.vertex_weights[c] += graph.vertex_weights[u];
+                    for(unsigned k=graph.first[u]; k<graph.first[u+1]; ++k)
+                    {
+                        unsigned cv = map[graph.adjacent[k]];
+                        if(cv==c)
+                            continue;
+                        if(position[cv]<0)
+                        {
+                            position[cv] = coarse.adjacent.size();
+                            coarse.adjacent.push_back(cv);
+                            coarse.edge_weights.push_back(graph.edge_weights[k]);
+                        }
+                        else
+                            coarse.edge_weights[position[cv]] += graph.edge_weights[k];
+                    }
+                }
+                for(unsigned k=row; k<coarse.adjacent.size(); ++k)
+                    position[coarse.adjacent[k]] = -1;
+                coarse.first[c+1] = coarse.adjacent.size();
+            }
+        };
+
+        //! Partition a set of vertices of an element graph by recursive bisection
+        /*! Each bisection grows a region by breadth first search from a
+            pseudo-peripheral vertex until it holds its share of the weight, then both
+            halves are split again */
+        //! \param graph The graph to partition
+        //! \param vertices The vertices to partition
+        //! \param first_part Number of the first part to assign
+        //! \param parts Number of parts to split vertices into
+        //! \param part Vector where to store the part of each vertex
+        inline void grow_element_graph_parts(ElementGraph const &graph,
+                                             std::vector<unsigned> const &vertices,
+                                             int const &first_part,
+                                             int const &parts,
+                                             std::vector<int> &part)
+        {
+            if(parts<=1 || vertices.size()<=1)
+            {
+                for(unsigned q=0; q<vertices.size(); ++q)
+                    part[vertices[q]] = first_part;
+                return;
+            }
+            int left_parts = parts/2;
+            long total = 0;
+            // 0 outside the set, 1 inside, 2 reached by the first search, 3 grown
+            std::vector<char> state(graph.size(), 0);
+            for(unsigned q=0; q<vertices.size(); ++q)
+            {
+                state[vertices[q]] = 1;
+                total += graph.vertex_weights[vertices[q]];
+            }
+            long target = total*left_parts/parts;
+
+            // the last vertex reached from any vertex is far from it
+            std::vector<unsigned> queue;
+            queue.reserve(vertices.size());
+            queue.push_back(vertices[0]);
+            state[vertices[0]] = 2;
+            for(unsigned head=0; head<queue.size(); ++head)
+                for(unsigned k=graph.first[queue[head]]; k<graph.first[queue[head]+1]; ++k)
+                    if(state[graph.adjacent[k]]==1)
+                    {
+                        state[graph.adjacent[k]] = 2;
+                        queue.push_back(graph.adjacent[k]);
+                    }
+            unsigned start = queue.back();
+            for(unsigned q=0; q<queue.size(); ++q)
+                state[queue[q]] = 1;
+
+            // grow the first half, restarting from unreached vertices if needed
+            queue.clear();
+            queue.push_back(start);
+            state[start] = 3;
+            long weight = graph.vertex_weights[start];
+            unsigned next = 0;
+            for(unsigned head=0; weight<target; )
+            {
+                if(head==queue.size())
+                {
+                    while(next<vertices.size() && state[vertices[next]]!=1)
+                        ++next;
+                    if(next==vertices.size())
+                        break;
+                    state[vertices[next]] = 3;
+                    weight += graph.vertex_weights[vertices[next]];
+                    queue.push_back(vertices[next]);
+                    continue;
+                }
+                unsigned u = queue[head++];
+                for(unsigned k=graph.first[u]; k<graph.first[u+1] && weight<target; ++k)
+                {
+                    unsigned v = graph.adjacent[k];
+                    if(state[v]!=1)
+                        continue;
+                    state[v] = 3;
+                    weight += graph.vertex_weights[v];
+                    queue.push_back(v);
+                }
+            }
+
+            std::vector<unsigned> left, right;
+            for(unsigned q=0; q<vertices.size(); ++q)
+                (state[vertices[q]]==3 ? left : right).push_back(vertices[q]);
+            grow_element_graph_parts(graph, left, first_part, left_parts, part);
+            grow_element_graph_parts(graph, right, first_part+left_parts, parts-left_parts,
+                                     part);
+        };
+
+        //! Improve a partition of an element graph by moving boundary vertices
+        /*! Vertices are moved greedily to the adjacent part that most reduces the
+            weight of cut edges, as long as no part grows heavier than its share by more
+            than imbalance; moves that do not change the cut are done if they improve
+            balance, and overweight parts give vertices away anyway. Passes over
+            vertices cost O(E) operations and stop when nothing moves */
+        //! \param graph The partitioned graph
+        //! \param parts Number of parts
+        //! \param imbalance Allowed relative excess of weight of each part
+        //! \param part Part of each vertex, improved in place
+        inline void refine_element_graph_parts(ElementGraph const &graph,
+                                               int const &parts,
+                                               double const &imbalance,
+                                               std::vector<int> &part)
+        {
+            unsigned n = graph.size();
+            std::vector<long> weights(parts, 0);
+            long total = 0;
+            for(unsigned i=0; i<n; ++i)
+            {
+                weights[part[i]] += graph.vertex_weights[i];
+                total += graph.vertex_weights[i];
+            }
+            long max_weight = (long)std::ceil((1.+imbalance)*total/parts);
+            std::vector<int> connection(parts, 0);
+            std::vector<int> touched;
+            for(int pass=0; pass<8; ++pass)
+            {
+                bool moved = false;
+                for(unsigned i=0; i<n; ++i)
+                {
+                    int own = part[i];
+                    int w = graph.vertex_weights[i];
+                    touched.clear();
+                    for(unsigned k=graph.first[i]; k<graph.first[i+1]; ++k)
+                    {
+                        int q = part[graph.adjacent[k]];
+                        if(!connection[q] && q!=own)
+                            touched.push_back(q);
+                        connection[q] += graph.edge_weights[k];
+                    }
+                    int best = own, best_gain = 0;
+                    bool overweight = weights[own]>max_weight;
+                    for(unsigned t=0; t<touched.size(); ++t)
+                    {
+                        int q = touched[t];
+                        int gain = connection[q]-connection[own];
+                        if(weights[q]+w>max_weight)
+                            continue;
+                        if(gain>best_gain
+                           || (best==own && gain==0 && weights[q]+w<weights[own])
+                           || (best==own && overweight))
+                        {
+                            best = q;
+                            best_gain = gain;
+                        }
+                    }
+                    for(unsigned t=0; t<touched.size(); ++t)
+                        connection[touched[t]] = 0;
+                    connection[own] = 0;
+                    if(best==own || weights[own]==w)
+                        continue;
+                    part[i] = best;
+                    weights[own] -= w;
+                    weights[best] += w;
+                    moved = true;
+                }
+                if(!moved)
+                    break;
+            }
+        };
+
+        /*! Split the elements of a Polygonation into balanced parts with few shared
+            edges, for domain decomposition and for assembly local to each processor.
+
+            The element graph is coarsened by heavy edge matching until it has a few
+            vertices per part, the coarsest graph is split by recursive bisection, then
+            the partition is projected back level by level and improved on each one by
+            moving boundary elements, as in multilevel k-way partitioners. Each level
+            costs O(E) operations */
+        //! \param polygonation The Polygonation to split
+        //! \param parts Number of parts
+        //! \param part Vector where to store the part, from 0 to parts-1, of each element
+        //! \param imbalance Allowed relative excess of elements of each part
+        template<class X>
+        void compute_polygonation_partition(Polygonation<2,X> const &polygonation,
+                                            int const &parts,
+                                            std::vector<int> &part,
+                                            double const &imbalance = 0.03)
+        {
+            unsigned n = polygonation.size();
+            part.assign(n, 0);
+            if(parts<=1 || n==0)
+                return;
+            std::vector<ElementGraph> graphs(1);
+            compute_element_graph(polygonation, graphs[0]);
+            std::vector< std::vector<unsigned> > maps;
+            unsigned coarsest = std::max(20u*parts, 100u);
+            while(graphs.back().size()>coarsest)
+            {
+                ElementGraph coarse;
+                std::vector<unsigned> map;
+                coarsen_element_graph(graphs.back(), coarse, map);
+                // stop when matching no longer shrinks the graph
+                if(coarse.size()>0.95*graphs.back().size())
+                    break;
+                graphs.push_back(coarse);
+                maps.push_back(std::vector<unsigned>());
+                maps.back().swap(map);
+            }
+
+            std::vector<int> coarse_part(graphs.back().size());
+            std::vector<unsigned> vertices(graphs.back().size());
+            for(unsigned i=0; i<vertices.size(); ++i)
+                vertices[i] = i;
+            grow_element_graph_parts(graphs.back(), vertices, 0, parts, coarse_part);
+            refine_element_graph_parts(graphs.back(), parts, imbalance, coarse_part);
+            for(unsigned l=maps.size(); l-->0; )
+            {
+                std::vector<int> fine_part(graphs[l].size());
+                for(unsigned i=0; i<fine_part.size(); ++i)
+                    fine_part[i] = coarse_part[maps[l][i]];
+                refine_element_graph_parts(graphs[l], parts, imbalance, fine_part);
+                coarse_part.swap(fine_part);
+            }
+            part.swap(coarse_part);
+        };
+
+        //! Get the elements of each part of a partition
+        //! \param part Part of each element
+        //! \param parts Number of parts
+        //! \param elements Vector where to store the sorted elements of each part
+        inline void compute_part_elements(std::vector<int> const &part,
+                                          int const &parts,
+                                          std::vector< std::vector<unsigned> > &elements)
+        {
+            elements.assign(parts, std::vector<unsigned>());
+            for(unsigned i=0; i<part.size(); ++i)
+                elements[part[i]].push_back(i);
+        };
+
+        //! Get the interface nodes of each part of a partition
+        /*! Interface nodes of a part are the nodes of its elements shared with
+            elements of other parts, where contributions of different parts to the
+            algebraic system must be summed */
+        //! \param space Space built on the partitioned Polygonation
+        //! \param part Part of each element
+        //! \param parts Number of parts
+        //! \param interface_nodes Vector where to store the sorted interface nodes of
+        //!                        each part
+        template<class X>
+        void compute_part_interface_nodes(SemSpace<2,X> const &space,
+                                          std::vector<int> const &part,
+                                          int const &parts,
+                                          std::vector< std::vector<unsigned> > &interface_nodes)
+        {
+            interface_nodes.assign(parts, std::vector<unsigned>());
+            std::vector<int> node_parts;
+            for(unsigned i=0; i<space.nodes(); ++i)
+            {
+                typename SemSpace<2,X>::Node const &node = space.node(i);
+                node_parts.clear();
+                for(int s=0; s<node.supportSubDomains(); ++s)
+                    node_parts.push_back(part[node.subDomainIndex(s).subIndex(0)]);
+                std::sort(node_parts.begin(), node_parts.end());
+                node_parts.erase(std::unique(node_parts.begin(), node_parts.end()),
+                                 node_parts.end());
+                if(node_parts.size()<2)
+                    continue;
+                for(unsigned q=0; q<node_parts.size(); ++q)
+                    interface_nodes[node_parts[q]].push_back(i);
+            }
+        };
+
+        //! Get the ghost layer of each part of a partition
+        /*! Ghost elements of a part are the elements of other parts sharing a node
+            with it, whose data a part needs to evaluate its interface nodes */
+        //! \param space Space built on the partitioned Polygonation
+        //! \param part Part of each element
+        //! \param parts Number of parts
+        //! \param ghosts Vector where to store the sorted ghost elements of each part
+        template<class X>
+        void compute_part_ghost_elements(SemSpace<2,X> const &space,
+                                         std::vector<int> const &part,
+                                         int const &parts,
+                                         std::vector< std::vector<unsigned> > &ghosts)
+        {
+            ghosts.assign(parts, std::vector<unsigned>());
+            for(unsigned i=0; i<space.nodes(); ++i)
+            {
+                typename SemSpace<2,X>::Node const &node = space.node(i);
+                for(int s=0; s<node.supportSubDomains(); ++s)
+                {
+                    int a = node.subDomainIndex(s).subIndex(0);
+                    for(int t=0; t<node.supportSubDomains(); ++t)
+                    {
+                        int b = node.subDomainIndex(t).subIndex(0);
+                        if(part[a]!=part[b])
+                            ghosts[part[a]].push_back(b);
+                    }
+                }
+            }
+            for(int p=0; p<parts; ++p)
+            {
+                std::sort(ghosts[p].begin(), ghosts[p].end());
+                ghosts[p].erase(std::unique(ghosts[p].begin(), ghosts[p].end()),
+                                ghosts[p].end());
+            }
+        };
+    }
+}
+
+#endif // PARTITIONPOLYGONATION_HPP
@@ -0,0 +1,124 @@
+#ifndef REORDERPOLYGONATION_HPP
+#define REORDERPOLYGONATION_HPP
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <CGAL/Bbox_2.h>
+#include <SemSolver/point.hpp>
+#include <SemSolver/polygonation.hpp>
+#include <SemSolver/semparameters.hpp>
+
+namespace SemSolver
+{
+    //! \brief PreProcessor namespace
+    /*! This namespace provides algorithms for the constuction of the geometric structures
+        associated to the problem from geometric information stored in PSLG format. */
+    namespace PreProcessor
+    {
+        //! Bits of each coordinate of points on space filling curves
+        static const int curve_bits = 16;
+
+        //! Get position of a cell along a Morton curve
+        /*! Bits of x and y are interleaved, x in even positions */
+        inline quint32 morton_curve_index(quint32 x, quint32 y)
+        {
+            quint32 d = 0;
+            for(int b=0; b<curve_bits; ++b)
+                d |= ((x>>b & 1) << 2*b) | ((y>>b & 1) << (2*b+1));
+            return d;
+        };
+
+        //! Get position of a cell along a Hilbert curve
+        /*! Quadrants are visited from the coarsest level, rotating and reflecting
+            coordinates so that each quadrant is entered where the previous one was
+            left */
+        inline quint32 hilbert_curve_index(quint32 x, quint32 y)
+        {
+            quint32 const n = 1u << curve_bits;
+            quint32 d = 0;
+            for(quint32 s=n/2; s>0; s/=2)
+            {
+                quint32 rx = (x & s) > 0;
+                quint32 ry = (y & s) > 0;
+                d += s * s * ((3 * rx) ^ ry);
+                if(ry==0)
+                {
+                    if(rx==1)
+                    {
+                        x = n-1-x;
+                        y = n-1-y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        };
+
+        /*! Compute an order of the elements of a Polygonation sorting their centroids
+            along a space filling curve, so that elements close in the order are close
+            in the plane. Centroids are scaled to the bounding box of the Polygonation
+            and snapped to a grid of 2^16 cells per side; ties keep the current order */
+        //! \param polygonation The Polygonation to order
+        //! \param ordering Curve to use, NATIVE gives the current order
+        //! \param order Old positions of elements, in their new order
+        template<class X>
+        void compute_polygonation_order(Polygonation<2,X> const &polygonation,
+                                        typename SemParameters<X>::Ordering const &ordering,
+                                        std::vector<unsigned> &order)
+        {
+            unsigned n = polygonation.size();
+            order.resize(n);
+            if(ordering==SemParameters<X>::NATIVE || n<2)
+            {
+                for(unsigned i=0; i<n; ++i)
+                    order[i] = i;
+                return;
+            }
+            std::vector< Point<2,X> > centroids(n);
+            CGAL::Bbox_2 box;
+            for(unsigned i=0; i<n; ++i)
+            {
+                typename Polygonation<2,X>::Element const &element = polygonation.element(i);
+                centroids[i] = centroid(element.verticesBegin(), element.verticesEnd());
+                box = i ? box + centroids[i].bbox() : centroids[i].bbox();
+            }
+            double side = std::max(box.xmax()-box.xmin(), box.ymax()-box.ymin());
+            double scale = side>0 ? ((1u << curve_bits)-1) / side : 0;
+            std::vector< std::pair<quint32, unsigned> > keys(n);
+            for(unsigned i=0; i<n; ++i)
+            {
+                quint32 x = (quint32)((CGAL::to_double(centroids[i].x())-box.xmin())*scale);
+                quint32 y = (quint32)((CGAL::to_double(centroids[i].y())-box.ymin())*scale);
+                keys[i].first = ordering==SemParameters<X>::HILBERT ? hilbert_curve_index(x, y)
+                                                                    : morton_curve_index(x, y);
+                keys[i].second = i;
+            }
+            std::sort(keys.begin(), keys.end());
+            for(unsigned i=0; i<n; ++i)
+                order[i] = keys[i].second;
+        };
+
+        /*! Reorder the elements of a Polygonation along a space filling curve, so that
+            consecutive subdomains, and the nodes of a space built on them, touch close
+            memory in assembly and post-processing. It must be done before the space is
+            built */
+        //! \param polygonation The Polygonation to reorder
+        //! \param ordering Curve to use, NATIVE leaves the Polygonation unchanged
+        template<class X>
+        void reorder_polygonation(Polygonation<2,X> &polygonation,
+                                  typename SemParameters<X>::Ordering const &ordering)
+        {
+            if(ordering==SemParameters<X>::NATIVE)
+                return;
+            std::vector<unsigned> order;
+            compute_polygonation_order(polygonation, ordering, order);
+            polygonation.reorder(order);
+        };
+    }
+}
+
+#endif // REORDERPOLYGONATION_HPP
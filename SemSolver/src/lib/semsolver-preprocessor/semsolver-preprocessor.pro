@@ -1,3 +1,8 @@
 TEMPLATE = subdirs
-HEADERS += computepolygonwithholesfrompslg.hpp \
+HEADERS += reorderpolygonation.hpp \
+    partitionpolygonation.hpp \
+    smoothpolygonation.hpp \
+    computequadrangulationfrompslg.hpp \
+    computepslghash.hpp \
+    computepolygonwithholesfrompslg.hpp \
     computepolygonationfrompslg.hpp
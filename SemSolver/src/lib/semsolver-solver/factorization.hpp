@@ -0,0 +1,277 @@
+#ifndef FACTORIZATION_HPP
+#define FACTORIZATION_HPP
+
+#if defined _WIN32 || defined _WIN64
+#	include <SemSolver/math_defines>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+#include <tnt_array1d.h>
+#include <tnt_array2d.h>
+#include <jama_cholesky.h>
+#include <jama_qr.h>
+
+#include <SemSolver/matrix.hpp>
+#include <SemSolver/vector.hpp>
+
+namespace SemSolver
+{
+    //! Solver namespace
+    /*! This namespace provides algorithms for solving an algebraic system A*x=b */
+    namespace Solver
+    {
+        //! Class for factorizations of a matrix which can be reused for many solves
+        /*! Factors are kept as plain arrays, so that they can be stored to a file and
+            later wrapped around its memory without being factorized again. */
+        template<class X>
+        class Factorization
+        {
+        public:
+            //! Factorization method
+            enum Type
+            {
+                NONE,
+                //! P*A = L*U with unit lower L, both stored in first factor
+                LU,
+                //! A = Q*R, first factor is Q and second one is R
+                QR,
+                //! A = L*L' with lower L stored in first factor
+                CHOLESKY
+            };
+
+        private:
+            Type                _type;
+            TNT::Array2D<X>     _first;
+            TNT::Array2D<X>     _second;
+            TNT::Array1D<int>   _pivot;
+
+        public:
+            //! Construct an empty factorization
+            Factorization()
+                : _type(NONE)
+            {
+            };
+
+            //! Construct a factorization over given factors
+            /*! Factors are neither copied nor freed, they must outlive the
+                factorization and are never modified by it */
+            //! \param type Factorization method
+            //! \param n Size of the factorized matrix
+            //! \param first First factor, n*n values by rows
+            //! \param second Second factor, n*n values by rows, QR only
+            //! \param pivot Row permutation, n values, LU only
+            Factorization(Type const &type,
+                          int const &n,
+                          X const *first,
+                          X const *second = 0,
+                          int const *pivot = 0)
+                : _type(type),
+                  _first(n, n, const_cast<X *>(first))
+            {
+                if(second)
+                    _second = TNT::Array2D<X>(n, n, const_cast<X *>(second));
+                if(pivot)
+                    _pivot = TNT::Array1D<int>(n, const_cast<int *>(pivot));
+            };
+
+            //! Factorize a matrix
+            //! \param type Factorization method
+            //! \param A Square matrix to be factorized
+            //! \return false if A is singular, not full rank or not SPD according to
+            //! method
+            bool factorize(Type const &type, Matrix<X> const &A);
+
+            //! Solve A*x=b using the factors of A
+            //! \param b constant term
+            //! \param x Vector reference to the computed solution
+            bool solve(Vector<X> const &b, Vector<X> &x) const;
+
+            //! Get factorization method
+            inline Type const &type() const
+            {
+                return _type;
+            };
+
+            //! Get size of the factorized matrix
+            inline int size() const
+            {
+                return _first.dim1();
+            };
+
+            //! Get first factor
+            inline TNT::Array2D<X> const &first() const
+            {
+                return _first;
+            };
+
+            //! Get second factor, empty unless QR
+            inline TNT::Array2D<X> const &second() const
+            {
+                return _second;
+            };
+
+            //! Get row permutation, empty unless LU
+            inline TNT::Array1D<int> const &pivot() const
+            {
+                return _pivot;
+            };
+        };
+    };
+};
+
+template<class X>
+bool SemSolver::Solver::Factorization<X>::factorize(Type const &type,
+                                                    Matrix<X> const &A)
+{
+    int n = A.rows();
+    _type = NONE;
+    _second = TNT::Array2D<X>();
+    _pivot = TNT::Array1D<int>();
+    if(type==LU)
+    {
+        // Doolittle elimination with partial pivoting done in place, as in JAMA::LU
+        // but without building separate L and U copies
+        _first = A.copy();
+        _pivot = TNT::Array1D<int>(n);
+        for(int i=0; i<n; ++i)
+            _pivot[i] = i;
+        for(int k=0; k<n; ++k)
+        {
+            int p = k;
+            for(int i=k+1; i<n; ++i)
+                if(std::abs(_first[i][k]) > std::abs(_first[p][k]))
+                    p = i;
+            if(p!=k)
+            {
+                for(int j=0; j<n; ++j)
+                    std::swap(_first[p][j], _first[k][j]);
+                std::swap(_pivot[p], _pivot[k]);
+            }
+            if(_first[k][k]==X(0))
+            {
+#ifdef SEMDEBUG
+                qWarning("SemSolver::Solver::Factorization::factorize - ERROR : Matrix A "\
+                         "is singular.");
+#endif
+                return false;
+            }
+            X const *row_k = _first[k];
+            for(int i=k+1; i<n; ++i)
+            {
+                X *row_i = _first[i];
+                X l = row_i[k] /= row_k[k];
+                if(l==X(0))
+                    continue;
+                for(int j=k+1; j<n; ++j)
+                    row_i[j] -= l * row_k[j];
+            }
+        }
+    }
+    else if(type==QR)
+    {
+        JAMA::QR<X> qr(A);
+        if(!qr.isFullRank())
+        {
+            qWarning("SemSolver::Solver::Factorization::factorize - ERROR : Matrix A is n"\
+                     "ot full rank.");
+            return false;
+        }
+        _first = qr.getQ();
+        _second = qr.getR();
+    }
+    else if(type==CHOLESKY)
+    {
+        JAMA::Cholesky<X> cholesky(A);
+        if(!cholesky.is_spd())
+        {
+            qWarning("SemSolver::Solver::Factorization::factorize - ERROR : Matrix A is n"\
+                     "ot a symmetric, positive definite matrix.");
+            return false;
+        }
+        _first = cholesky.getL();
+    }
+    else
+        return false;
+    _type = type;
+    return true;
+};
+
+template<class X>
+bool SemSolver::Solver::Factorization<X>::solve(Vector<X> const &b,
+                                                Vector<X> &x) const
+{
+    int n = size();
+    if(_type==NONE || b.rows()!=n)
+    {
+#ifdef SEMDEBUG
+        qWarning("SemSolver::Solver::Factorization::solve - ERROR : constant term does n"\
+                 "ot match factorization.");
+#endif
+        return false;
+    }
+    x = Vector<X>(n);
+    if(_type==LU)
+    {
+        // L*y = P*b, then U*x = y
+        for(int i=0; i<n; ++i)
+        {
+            X const *row = _first[i];
+            X sum = b[_pivot[i]];
+            for(int j=0; j<i; ++j)
+                sum -= row[j] * x[j];
+            x[i] = sum;
+        }
+        for(int i=n-1; i>=0; --i)
+        {
+            X const *row = _first[i];
+            X sum = x[i];
+            for(int j=i+1; j<n; ++j)
+                sum -= row[j] * x[j];
+            x[i] = sum / row[i];
+        }
+    }
+    else if(_type==QR)
+    {
+        // R*x = Q'*b
+        for(int i=0; i<n; ++i)
+            x[i] = X(0);
+        for(int k=0; k<n; ++k)
+        {
+            X const *row = _first[k];
+            for(int i=0; i<n; ++i)
+                x[i] += row[i] * b[k];
+        }
+        for(int i=n-1; i>=0; --i)
+        {
+            X const *row = _second[i];
+            X sum = x[i];
+            for(int j=i+1; j<n; ++j)
+                sum -= row[j] * x[j];
+            x[i] = sum / row[i];
+        }
+    }
+    else
+    {
+        // L*y = b, then L'*x = y
+        for(int i=0; i<n; ++i)
+        {
+            X const *row = _first[i];
+            X sum = b[i];
+            for(int j=0; j<i; ++j)
+                sum -= row[j] * x[j];
+            x[i] = sum / row[i];
+        }
+        for(int i=n-1; i>=0; --i)
+        {
+            X sum = x[i] / _first[i][i];
+            x[i] = sum;
+            for(int j=0; j<i; ++j)
+                x[j] -= _first[i][j] * sum;
+        }
+    }
+    return true;
+};
+
+#endif // FACTORIZATION_HPP
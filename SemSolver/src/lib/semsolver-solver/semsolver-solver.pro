@@ -1,4 +1,6 @@
 TEMPLATE = subdirs
 HEADERS += qrsolve.hpp \
     lusolve.hpp \
-    choleskysolve.hpp
+    factorization.hpp \
+    choleskysolve.hpp \
+    multigrid.hpp
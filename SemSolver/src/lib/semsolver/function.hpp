@@ -7,6 +7,7 @@ namespace SemSolver
     class Function;
 };
 
+#include <vector>
 
 //! \brief Project main namespace
 namespace SemSolver
@@ -31,6 +32,19 @@ namespace SemSolver
         //! \return value assumed by function at x
         virtual Y evaluate(X const &) const { return Y(); };
 
+        //! \brief Evaluate function at many points
+        /*! Derived classes may override it with a faster algorithm than calling
+            evaluate on each point */
+        //! \param points The points where to evaluate function
+        //! \param values Vector where to store values in the same order as points
+        virtual void evaluateBatch(std::vector<X> const &points,
+                                   std::vector<Y> &values) const
+        {
+            values.resize(points.size());
+            for(unsigned i=0; i<points.size(); ++i)
+                values[i] = evaluate(points[i]);
+        };
+
         //! \brief Get function definition in Mathematical Markup Language notation
         //! \return QString of function definition in MathML format
         virtual QString mml() const { return ""; };
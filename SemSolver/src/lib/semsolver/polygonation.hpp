@@ -16,8 +16,18 @@ namespace SemSolver
     class Polygonation;
 };
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
 #include <vector>
 
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <CGAL/Bbox_2.h>
+
 #include <SemSolver/polygon.hpp>
 #include <SemSolver/point.hpp>
 
@@ -121,21 +131,181 @@ namespace SemSolver
         };
 
     private:
+        //! Range of element positions handled by one task
+        struct Range
+        {
+            unsigned first;
+            unsigned last;
+        };
+
+        //! Find for each edge its position in the neighbour sharing it
+        struct FindTwins
+        {
+            typedef void result_type;
+
+            std::vector<Element> const *elements;
+            std::vector<unsigned> const *first;
+            std::vector<int> *twins;
+
+            void operator()(Range const &range) const;
+        };
+
+        //! Split elements of a range into subelements
+        /*! Subelement j of element i is placed at first[i]+j. Neighbour ids of
+            subelements are computed from the positions of shared edges in the
+            neighbours, got from twins, or, if twins is empty, from the layout of
+            subelements, which for quadrangles produced by a previous split puts the
+            edges 0 and 1, 2 and 3 of adjacent elements against each other */
+        struct Subdivide
+        {
+            typedef void result_type;
+
+            std::vector<Element> const *elements;
+            std::vector<unsigned> const *first;
+            std::vector<int> const *twins;
+            std::vector<Element> *subelements;
+            std::vector<unsigned> *parents;
+
+            void operator()(Range const &range) const;
+        };
+
+        //! Key of an edge, from its first vertex to its second one
+        typedef std::pair< std::pair<X,X>, std::pair<X,X> > EdgeKey;
+
+        //! \brief Get the key of an edge
+        static inline EdgeKey edgeKey(Point<2, X> const &from,
+                                      Point<2, X> const &to);
+
         std::vector<Element> elements;
 
+        // coarser levels of the hierarchy built by refine, from the coarsest one; the
+        // children of element i of level l are children_list[l][k] on level l+1, for
+        // k from children_first[l][i] to children_first[l][i+1]-1, and parents[l] are
+        // the parents of elements of level l+1
+        std::vector< std::vector<Element> >  coarse_elements;
+        std::vector< std::vector<unsigned> > children_first;
+        std::vector< std::vector<unsigned> > children_list;
+        std::vector< std::vector<unsigned> > parents;
+
+        // uniform grid of element bounding boxes used for point location, it is
+        // built on first query and invalidated whenever elements change
+        mutable bool                      index_built;
+        mutable std::vector<CGAL::Bbox_2> boxes;
+        mutable CGAL::Bbox_2              index_box;
+        mutable int                       index_columns;
+        mutable int                       index_rows;
+        mutable std::vector<unsigned>     cell_first;
+        mutable std::vector<unsigned>     cell_elements;
+
+        //! \brief Get the grid cell containing a point
+        //! \return The cell position or -1 if point is outside grid
+        inline int cellAt(Point<2, X> const &point) const;
+
+        //! \brief Test if a point lies on the bounding box of an Element
+        inline bool boxContains(unsigned const &index,
+                                Point<2, X> const &point) const;
+
     public:
+        //! \brief Default constructor
+        inline Polygonation();
+
         //! \brief Test if Polygonation is a quadrangualtion
         //! \return The test result
         bool isQuadrangulation() const;
 
         //! \brief Refine the Polygonation
         /*! Split all elements into subelements, one for each vertex, by adding as
-            vertices the centroid of each element and the midpoint of each segment */
-        void refine();
+            vertices the centroid of each element and the midpoint of each segment.
+            Elements are split in parallel, and neighbour ids of subelements are
+            computed from the position of each shared edge in both neighbours, which is
+            searched once and then known by construction for the following levels.
+            The current elements are kept as a coarser level of the hierarchy.
+            The Polygonation must be conforming, see refineMarked */
+        //! \param levels Number of times elements are split
+        void refine(unsigned const &levels = 1);
+
+        //! \brief Refine marked elements only
+        /*! Marked elements are split as in refine, the others are kept. Edges of a
+            split element faced by an element that is not split become nonconforming:
+            the two halves face the whole edge, which has a hanging vertex at its
+            midpoint. Marks are first extended to the coarser neighbours of marked
+            elements, so that each edge faces at most two edges of half its length.
+            Neighbour ids of the halves point to the element with the whole edge, and
+            the neighbour id of the whole edge points to one of the halves; they are
+            found by hashing edges in O(M log M) time. The current elements are kept as
+            a coarser level of the hierarchy, each element that is not split being
+            its only child */
+        //! \param marked Flag for each element, true if it must be split
+        void refineMarked(std::vector<bool> const &marked);
 
-        //! \brief Clear the Polygonation
+        //! \brief Find the edge of a neighbour facing an edge of an element
+        //! \param index Element position
+        //! \param j Edge position, edge j goes from vertex j-1 to vertex j
+        //! \param half Set to true if edge j is only half of the edge it faces
+        /*! \return Position of the faced edge in the neighbour across edge j, -1 if
+                    edge j is on the border or if it faces two halves of itself */
+        int facingEdge(unsigned const &index,
+                       int const &j,
+                       bool &half) const;
+
+        //! \brief Clear the Polygonation and its hierarchy
         inline void clear();
 
+        //! \brief Drop coarser levels of the hierarchy, keeping current elements
+        inline void clearHierarchy();
+
+        //! \brief Get number of levels of the hierarchy
+        /*! Level 0 is the coarsest one, level levels()-1 holds the current elements.
+            Adding elements drops the hierarchy */
+        inline unsigned levels() const;
+
+        //! \brief Get number of elements on a level of the hierarchy
+        inline unsigned levelSize(unsigned const &level) const;
+
+        //! \brief Get an element of a level of the hierarchy
+        inline Element const &levelElement(unsigned const &level,
+                                           unsigned const &index) const;
+
+        //! \brief Get position of the parent of an element
+        //! \param level Level of the element, at least 1
+        //! \param index Position of the element on its level
+        //! \return Position of the parent on level-1
+        inline unsigned parent(unsigned const &level,
+                               unsigned const &index) const;
+
+        //! \brief Get number of children of an element
+        //! \param level Level of the element, at most levels()-2
+        //! \param index Position of the element on its level
+        inline unsigned children(unsigned const &level,
+                                 unsigned const &index) const;
+
+        //! \brief Get position of a child of an element
+        //! \param level Level of the element, at most levels()-2
+        //! \param index Position of the element on its level
+        //! \param k Child number, less than children(level, index)
+        //! \return Position of the child on level+1
+        inline unsigned child(unsigned const &level,
+                              unsigned const &index,
+                              unsigned const &k) const;
+
+        //! \brief Reorder current elements
+        /*! Neighbour ids and the hierarchy are updated accordingly */
+        //! \param order Old positions of elements, in their new order
+        void reorder(std::vector<unsigned> const &order);
+
+        //! \brief Move the vertices of a current element
+        /*! Neighbour ids and the hierarchy are kept, so shared vertices must be moved
+            alike in all the elements they belong to */
+        //! \param index Element position
+        //! \param first Pointer to the first new vertex
+        //! \param last Pointer past the last new vertex, as many as the old ones
+        inline void setElementGeometry(unsigned const &index,
+                                       Point<2, X> const *first,
+                                       Point<2, X> const *last);
+
+        //! \brief Reserve storage for a number of elements
+        inline void reserve(unsigned const &n);
+
         //! Get an Element
         //! \param index Element's position
         //! \return reference to Element
@@ -155,9 +325,30 @@ namespace SemSolver
         //! \param point The Point to check
         //! \return Vector of position of that elements that contain the given point
         std::vector<unsigned> elementIndicesAt(Point<2, X> const &point) const;
+
+        //! Get one Element on which lies a Point
+        /*! If hint is a valid Element position the search starts from there and walks
+            through neighbours towards the point, so that consecutive queries on nearby
+            points cost O(1). Otherwise, or if the walk hits the boundary, the point is
+            located with the grid index */
+        //! \param point The Point to check
+        //! \param hint Position of the Element where to start the search
+        //! \return Position of an Element containing the point, -1 if there is none
+        int elementIndexAt(Point<2, X> const &point,
+                           int const &hint = -1) const;
+
+        //! Build the point location index
+        /*! It is built automatically on first query, and rebuilt only after elements
+            change. Call it explicitly before sharing a Polygonation among threads */
+        void buildIndex() const;
     };
 };
 
+template<class X>
+inline SemSolver::Polygonation<2, X>::Polygonation()
+    : index_built(false)
+{};
+
 template<class X>
 bool SemSolver::Polygonation<2, X>::isQuadrangulation() const
 {
@@ -171,20 +362,49 @@ bool SemSolver::Polygonation<2, X>::isQuadrangulation() const
 };
 
 template<class X>
-void SemSolver::Polygonation<2, X>::refine()
+void SemSolver::Polygonation<2, X>::FindTwins::operator()(Range const &range) const
 {
-    int *subelements_first = new int[size()];
-    subelements_first[0]=0;
-    for(unsigned i=0; i<size()-1; ++i)
-        subelements_first[i+1]=subelements_first[i]+element(i).size();
-    std::vector<Element> subelements;
-    for(unsigned i=0; i<size(); ++i)
+    for(unsigned i=range.first; i<range.last; ++i)
+    {
+        Element const &element = (*elements)[i];
+        int n = element.size();
+        for(int j=0; j<n; ++j)
+        {
+            int &twin = (*twins)[(*first)[i]+j];
+            twin = -1;
+            if(element.neighbour(j)<0) // border
+                continue;
+            // edge j goes from vertex j-1 to vertex j, in the neighbour the same edge
+            // goes from vertex j to vertex j-1
+            Element const &neigh = (*elements)[element.neighbour(j)-1];
+            Point<2, X> const from = element.vertex((j+n-1)%n);
+            Point<2, X> const to = element.vertex(j);
+            int m = neigh.size();
+            for(int q=0; q<m && twin<0; ++q)
+                if(neigh.vertex(q)==from && neigh.vertex((q+m-1)%m)==to)
+                    twin = q;
+#ifdef SEMDEBUG
+            if(twin<0)
+                qFatal("SemSolver::Polygonation::refine - ERROR : neighbours do not share"\
+                       " an edge.");
+#endif
+            if(twin<0)
+                twin = 0;
+        }
+    }
+};
+
+template<class X>
+void SemSolver::Polygonation<2, X>::Subdivide::operator()(Range const &range) const
+{
+    Point<2,X> vertices[4];
+    Element subelement;
+    for(unsigned i=range.first; i<range.last; ++i)
     {
-        Element const &old_element = element(i);
+        Element const &old_element = (*elements)[i];
         Point<2,X> cent = centroid(old_element.verticesBegin(),
                                    old_element.verticesEnd());
-        Point<2,X> vertices[4];
-        Polygonation::Element subelement;
+        unsigned i_first = (*first)[i];
         int n = old_element.size();
         for(int j=0; j<n; ++j)
         {
@@ -195,39 +415,403 @@ void SemSolver::Polygonation<2, X>::refine()
             vertices[3] = midpoint(old_element.vertex(j),
                                    old_element.vertex((j+n-1)%n));
             subelement.setGeometry(vertices, vertices+4);
-            if(old_element.neighbour(j)<0) // border
-                subelement.setNeighbour(0,old_element.neighbour(j));
+            // half of edge j next to vertex j, faced by the subelement of the
+            // neighbour at its vertex twin-1
+            int id = old_element.neighbour(j);
+            if(id<0) // border
+                subelement.setNeighbour(0, id);
             else
             {
-                int neigh = old_element.neighbour(j)-1;
-                int neigh_first = subelements_first[neigh];
-                element(neigh);
-                old_element.vertex(j);
-                int pos = element(neigh).vertexPosition(old_element.vertex(j));
-                subelement.setNeighbour(0,neigh_first+pos+1);
+                unsigned neigh_first = (*first)[id-1];
+                int m = (*first)[id]-neigh_first;
+                int twin = twins->empty() ? j^1 : (*twins)[i_first+j];
+                subelement.setNeighbour(0, neigh_first+(twin+m-1)%m+1);
             }
-            if(old_element.neighbour((j+1)%n)<0)
-                subelement.setNeighbour(1, old_element.neighbour((j+1)%n));
+            // half of edge j+1 next to vertex j, faced by the subelement of the
+            // neighbour at its vertex twin
+            id = old_element.neighbour((j+1)%n);
+            if(id<0)
+                subelement.setNeighbour(1, id);
             else
             {
-                int neigh = old_element.neighbour((j+1)%n)-1;
-                int neigh_first = subelements_first[neigh];
-                int pos = element(neigh).vertexPosition(old_element.vertex(j));
-                subelement.setNeighbour(1, neigh_first+pos+1);
+                unsigned neigh_first = (*first)[id-1];
+                int twin = twins->empty() ? ((j+1)%n)^1 : (*twins)[i_first+(j+1)%n];
+                subelement.setNeighbour(1, neigh_first+twin+1);
             }
-            subelement.setNeighbour(2,subelements_first[i]+(j+1)%n+1);
-            subelement.setNeighbour(3,subelements_first[i]+(j+n-1)%n+1);
-            subelements.push_back(subelement);
+            subelement.setNeighbour(2, i_first+(j+1)%n+1);
+            subelement.setNeighbour(3, i_first+(j+n-1)%n+1);
+            (*subelements)[i_first+j] = subelement;
+            (*parents)[i_first+j] = i;
         }
     }
-    elements.clear();
-    elements = subelements;
+};
+
+template<class X>
+void SemSolver::Polygonation<2, X>::refine(unsigned const &levels)
+{
+    std::vector<int> twins;
+    for(unsigned level=0; level<levels && size(); ++level)
+    {
+        unsigned n = size();
+        std::vector<unsigned> first(n+1);
+        first[0] = 0;
+        for(unsigned i=0; i<n; ++i)
+            first[i+1] = first[i]+element(i).size();
+
+        unsigned chunks = 4*QThread::idealThreadCount();
+        if(chunks<1)
+            chunks = 1;
+        unsigned chunk_size = (n+chunks-1)/chunks;
+        QVector<Range> ranges;
+        for(unsigned begin=0; begin<n; begin+=chunk_size)
+        {
+            Range range = { begin, std::min(begin+chunk_size, n) };
+            ranges.push_back(range);
+        }
+
+        // positions of shared edges are searched only on the first level, the
+        // subelements built here are quadrangles whose edge 0 faces edge 1 of the
+        // adjacent subelement and edge 2 faces edge 3
+        if(level==0)
+        {
+            twins.resize(first[n]);
+            FindTwins find;
+            find.elements = &elements;
+            find.first = &first;
+            find.twins = &twins;
+            QtConcurrent::blockingMap(ranges, find);
+        }
+        else
+            twins.clear();
+
+        std::vector<Element> subelements(first[n]);
+        std::vector<unsigned> subelements_parents(first[n]);
+        Subdivide subdivide;
+        subdivide.elements = &elements;
+        subdivide.first = &first;
+        subdivide.twins = &twins;
+        subdivide.subelements = &subelements;
+        subdivide.parents = &subelements_parents;
+        QtConcurrent::blockingMap(ranges, subdivide);
+
+        coarse_elements.push_back(std::vector<Element>());
+        coarse_elements.back().swap(elements);
+        children_first.push_back(std::vector<unsigned>());
+        children_first.back().swap(first);
+        children_list.push_back(std::vector<unsigned>(subelements.size()));
+        for(unsigned k=0; k<subelements.size(); ++k)
+            children_list.back()[k] = k;
+        parents.push_back(std::vector<unsigned>());
+        parents.back().swap(subelements_parents);
+        elements.swap(subelements);
+    }
+    index_built = false;
+};
+
+template<class X>
+void SemSolver::Polygonation<2, X>::refineMarked(std::vector<bool> const &marked)
+{
+    unsigned n = size();
+#ifdef SEMDEBUG
+    if(marked.size()!=n)
+        qFatal("SemSolver::Polygonation::refineMarked - ERROR : marks do not match eleme"\
+               "nts.");
+#endif //SEMDEBUG
+
+    // split also coarser neighbours of split elements, so that no edge gets more
+    // than one hanging vertex
+    std::vector<bool> split(marked);
+    split.resize(n, false);
+    std::vector<unsigned> stack;
+    for(unsigned i=0; i<n; ++i)
+        if(split[i])
+            stack.push_back(i);
+    while(!stack.empty())
+    {
+        unsigned i = stack.back();
+        stack.pop_back();
+        for(int j=0; j<element(i).size(); ++j)
+        {
+            bool half;
+            if(facingEdge(i, j, half)<0 || !half)
+                continue;
+            unsigned c = element(i).neighbour(j)-1;
+            if(!split[c])
+            {
+                split[c] = true;
+                stack.push_back(c);
+            }
+        }
+    }
+
+    // split marked elements, interior neighbour ids are found later
+    std::vector<unsigned> first(n+1);
+    first[0] = 0;
+    for(unsigned i=0; i<n; ++i)
+        first[i+1] = first[i] + (split[i] ? element(i).size() : 1);
+    std::vector<Element> refined(first[n]);
+    std::vector<unsigned> refined_parents(first[n]);
+    Point<2,X> vertices[4];
+    for(unsigned i=0; i<n; ++i)
+    {
+        Element const &old_element = elements[i];
+        if(!split[i])
+        {
+            refined[first[i]] = old_element;
+            refined_parents[first[i]] = i;
+            continue;
+        }
+        Point<2,X> cent = centroid(old_element.verticesBegin(),
+                                   old_element.verticesEnd());
+        int m = old_element.size();
+        for(int j=0; j<m; ++j)
+        {
+            vertices[0] = old_element.vertex(j);
+            vertices[1] = midpoint(old_element.vertex(j),
+                                   old_element.vertex((j+1)%m));
+            vertices[2] = cent;
+            vertices[3] = midpoint(old_element.vertex(j),
+                                   old_element.vertex((j+m-1)%m));
+            Element &subelement = refined[first[i]+j];
+            subelement.setGeometry(vertices, vertices+4);
+            subelement.setNeighbour(0, std::min(old_element.neighbour(j), 0));
+            subelement.setNeighbour(1, std::min(old_element.neighbour((j+1)%m), 0));
+            refined_parents[first[i]+j] = i;
+        }
+    }
+
+    // each interior edge faces the same edge, or half of it, or one of its halves
+    typedef std::map<EdgeKey, unsigned> EdgesMap;
+    typedef typename EdgesMap::const_iterator EdgeConstIterator;
+    EdgesMap edges, halves;
+    for(unsigned e=0; e<refined.size(); ++e)
+    {
+        Element const &current = refined[e];
+        int m = current.size();
+        for(int j=0; j<m; ++j)
+        {
+            Point<2,X> const from = current.vertex((j+m-1)%m);
+            Point<2,X> const to = current.vertex(j);
+            Point<2,X> const middle = midpoint(from, to);
+            edges[edgeKey(from, to)] = e;
+            halves[edgeKey(from, middle)] = e;
+            halves[edgeKey(middle, to)] = e;
+        }
+    }
+    for(unsigned e=0; e<refined.size(); ++e)
+    {
+        Element &current = refined[e];
+        int m = current.size();
+        for(int j=0; j<m; ++j)
+        {
+            if(current.neighbour(j)<0) // border
+                continue;
+            Point<2,X> const from = current.vertex((j+m-1)%m);
+            Point<2,X> const to = current.vertex(j);
+            Point<2,X> const middle = midpoint(from, to);
+            EdgeConstIterator it;
+            if((it = edges.find(edgeKey(to, from)))==edges.end()
+               && (it = halves.find(edgeKey(to, from)))==halves.end()
+               && (it = edges.find(edgeKey(to, middle)))==edges.end()
+               && (it = edges.find(edgeKey(middle, from)))==edges.end())
+            {
+#ifdef SEMDEBUG
+                qFatal("SemSolver::Polygonation::refineMarked - ERROR : edge faces no ot"\
+                       "her edge.");
+#endif
+                current.setNeighbour(j, 0);
+                continue;
+            }
+            current.setNeighbour(j, it->second+1);
+        }
+    }
+
+    coarse_elements.push_back(std::vector<Element>());
+    coarse_elements.back().swap(elements);
+    children_first.push_back(std::vector<unsigned>());
+    children_first.back().swap(first);
+    children_list.push_back(std::vector<unsigned>(refined.size()));
+    for(unsigned k=0; k<refined.size(); ++k)
+        children_list.back()[k] = k;
+    parents.push_back(std::vector<unsigned>());
+    parents.back().swap(refined_parents);
+    elements.swap(refined);
+    index_built = false;
+};
+
+template<class X>
+int SemSolver::Polygonation<2, X>::facingEdge(unsigned const &index,
+                                              int const &j,
+                                              bool &half) const
+{
+    Element const &current = element(index);
+    half = false;
+    int id = current.neighbour(j);
+    if(id<=0) // border
+        return -1;
+    int n = current.size();
+    Point<2, X> const from = current.vertex((j+n-1)%n);
+    Point<2, X> const to = current.vertex(j);
+    Element const &neigh = element(id-1);
+    int m = neigh.size();
+    for(int q=0; q<m; ++q)
+    {
+        // the faced edge goes the other way round
+        Point<2, X> const a = neigh.vertex((q+m-1)%m);
+        Point<2, X> const b = neigh.vertex(q);
+        if(a==to && b==from)
+            return q;
+        Point<2, X> const middle = midpoint(a, b);
+        if((a==to && middle==from) || (middle==to && b==from))
+        {
+            half = true;
+            return q;
+        }
+    }
+    return -1;
+};
+
+template<class X>
+inline typename SemSolver::Polygonation<2, X>::EdgeKey
+        SemSolver::Polygonation<2, X>::edgeKey(SemSolver::Point<2, X> const &from,
+                                               SemSolver::Point<2, X> const &to)
+{
+    return EdgeKey(std::make_pair(from.x(), from.y()), std::make_pair(to.x(), to.y()));
 };
 
 template<class X>
 inline void SemSolver::Polygonation<2, X>::clear()
 {
     elements.clear();
+    clearHierarchy();
+    index_built = false;
+};
+
+template<class X>
+inline void SemSolver::Polygonation<2, X>::clearHierarchy()
+{
+    coarse_elements.clear();
+    children_first.clear();
+    children_list.clear();
+    parents.clear();
+};
+
+template<class X>
+inline unsigned SemSolver::Polygonation<2, X>::levels() const
+{
+    return coarse_elements.size()+1;
+};
+
+template<class X>
+inline unsigned SemSolver::Polygonation<2, X>::levelSize(unsigned const &level) const
+{
+#ifdef SEMDEBUG
+    if(level>=levels())
+        qFatal("SemSolver::Polygonation::levelSize - ERROR : level out of bounds.");
+#endif //SEMDEBUG
+    return level<coarse_elements.size() ? coarse_elements[level].size()
+                                        : elements.size();
+};
+
+template<class X>
+inline const typename SemSolver::Polygonation<2, X>::Element
+        &SemSolver::Polygonation<2, X>::levelElement(unsigned const &level,
+                                                     unsigned const &index) const
+{
+#ifdef SEMDEBUG
+    if(level>=levels() || index>=levelSize(level))
+        qFatal("SemSolver::Polygonation::levelElement - ERROR : index out of bounds.");
+#endif //SEMDEBUG
+    return level<coarse_elements.size() ? coarse_elements[level][index]
+                                        : elements[index];
+};
+
+template<class X>
+inline unsigned SemSolver::Polygonation<2, X>::parent(unsigned const &level,
+                                                      unsigned const &index) const
+{
+#ifdef SEMDEBUG
+    if(level<1 || level>=levels() || index>=levelSize(level))
+        qFatal("SemSolver::Polygonation::parent - ERROR : index out of bounds.");
+#endif //SEMDEBUG
+    return parents[level-1][index];
+};
+
+template<class X>
+inline unsigned SemSolver::Polygonation<2, X>::children(unsigned const &level,
+                                                        unsigned const &index) const
+{
+#ifdef SEMDEBUG
+    if(level+1>=levels() || index>=levelSize(level))
+        qFatal("SemSolver::Polygonation::children - ERROR : index out of bounds.");
+#endif //SEMDEBUG
+    return children_first[level][index+1]-children_first[level][index];
+};
+
+template<class X>
+inline unsigned SemSolver::Polygonation<2, X>::child(unsigned const &level,
+                                                     unsigned const &index,
+                                                     unsigned const &k) const
+{
+#ifdef SEMDEBUG
+    if(level+1>=levels() || index>=levelSize(level) || k>=children(level, index))
+        qFatal("SemSolver::Polygonation::child - ERROR : index out of bounds.");
+#endif //SEMDEBUG
+    return children_list[level][children_first[level][index]+k];
+};
+
+template<class X>
+void SemSolver::Polygonation<2, X>::reorder(std::vector<unsigned> const &order)
+{
+    unsigned n = size();
+#ifdef SEMDEBUG
+    if(order.size()!=n)
+        qFatal("SemSolver::Polygonation::reorder - ERROR : order does not match elements.");
+#endif //SEMDEBUG
+    std::vector<unsigned> position(n);
+    for(unsigned k=0; k<n; ++k)
+        position[order[k]] = k;
+    std::vector<Element> reordered(n);
+    for(unsigned k=0; k<n; ++k)
+    {
+        Element &element = reordered[k];
+        element = elements[order[k]];
+        for(int j=0; j<element.size(); ++j)
+            if(element.neighbour(j)>0)
+                element.setNeighbour(j, position[element.neighbour(j)-1]+1);
+    }
+    elements.swap(reordered);
+    if(!coarse_elements.empty())
+    {
+        std::vector<unsigned> &last_children = children_list.back();
+        for(unsigned k=0; k<last_children.size(); ++k)
+            last_children[k] = position[last_children[k]];
+        std::vector<unsigned> reordered_parents(n);
+        for(unsigned k=0; k<n; ++k)
+            reordered_parents[k] = parents.back()[order[k]];
+        parents.back().swap(reordered_parents);
+    }
+    index_built = false;
+};
+
+template<class X>
+inline void SemSolver::Polygonation<2, X>::setElementGeometry(unsigned const &index,
+                                                              Point<2, X> const *first,
+                                                              Point<2, X> const *last)
+{
+#ifdef SEMDEBUG
+    if(index>=size() || last-first!=elements[index].size())
+        qFatal("SemSolver::Polygonation::setElementGeometry - ERROR : index out of bound"\
+               "s or wrong number of vertices.");
+#endif //SEMDEBUG
+    elements[index].setGeometry(first, last);
+    index_built = false;
+};
+
+template<class X>
+inline void SemSolver::Polygonation<2, X>::reserve(unsigned const &n)
+{
+    elements.reserve(n);
 };
 
 template<class X>
@@ -252,6 +836,8 @@ inline void SemSolver::Polygonation<2, X>::addElement(Polygon<2, X> const &polyg
                                                       std::vector<int> const &neighbours)
 {
     elements.push_back(Element(polygon, neighbours));
+    clearHierarchy();
+    index_built = false;
 };
 
 template<class X>
@@ -259,12 +845,152 @@ std::vector<unsigned> SemSolver::Polygonation<2, X>::elementIndicesAt(
         SemSolver::Point<2, X> const &point) const
 {
     std::vector<unsigned> indices;
-    for(unsigned i=0; i<size(); ++i)
-        if(element(i).contains(point))
+    int cell = cellAt(point);
+    if(cell<0)
+        return indices;
+    for(unsigned k=cell_first[cell]; k<cell_first[cell+1]; ++k)
+    {
+        unsigned i = cell_elements[k];
+        if(boxContains(i, point) && element(i).contains(point))
             indices.push_back(i);
+    }
     return indices;
 };
 
+template<class X>
+int SemSolver::Polygonation<2, X>::elementIndexAt(SemSolver::Point<2, X> const &point,
+                                                  int const &hint) const
+{
+    int i = hint;
+    // walk through neighbours, each step crosses an edge that separates the current
+    // element from the point; at most size() steps are needed on convex elements
+    for(unsigned steps=0; i>=0 && i<(int)size() && steps<size(); ++steps)
+    {
+        Element const &current = element(i);
+        int n = current.size();
+        int next = -1;
+        for(int j=0; j<n && next<0; ++j)
+        {
+            // neighbour j lies across the edge from vertex j-1 to vertex j
+            if(CGAL::orientation(current.vertex((j+n-1)%n), current.vertex(j), point)
+                == CGAL::RIGHT_TURN)
+            {
+                next = current.neighbour(j);
+                if(next<=0) // border
+                    next = -2;
+            }
+        }
+        if(next==-1)
+            return i;
+        i = next-1;
+    }
+    int cell = cellAt(point);
+    if(cell<0)
+        return -1;
+    for(unsigned k=cell_first[cell]; k<cell_first[cell+1]; ++k)
+    {
+        unsigned j = cell_elements[k];
+        if(boxContains(j, point) && element(j).contains(point))
+            return j;
+    }
+    return -1;
+};
+
+template<class X>
+void SemSolver::Polygonation<2, X>::buildIndex() const
+{
+    if(index_built)
+        return;
+    boxes.clear();
+    cell_first.clear();
+    cell_elements.clear();
+    index_columns = index_rows = 0;
+    if(!size())
+    {
+        index_built = true;
+        return;
+    }
+
+    boxes.reserve(size());
+    for(unsigned i=0; i<size(); ++i)
+        boxes.push_back(element(i).geometry().bbox());
+    index_box = boxes[0];
+    for(unsigned i=1; i<size(); ++i)
+        index_box = index_box + boxes[i];
+
+    // about one element per cell, with cells shaped as the domain bounding box
+    double width = index_box.xmax()-index_box.xmin();
+    double height = index_box.ymax()-index_box.ymin();
+    double side = std::sqrt(width*height/size());
+    if(side>0)
+    {
+        index_columns = std::max(1, (int)std::ceil(width/side));
+        index_rows = std::max(1, (int)std::ceil(height/side));
+    }
+    else
+        index_columns = index_rows = 1;
+    int cells = index_columns*index_rows;
+    index_built = true;
+
+    // count, then fill, elements overlapping each cell (compressed row storage)
+    std::vector<int> first_column(size()), last_column(size());
+    std::vector<int> first_row(size()), last_row(size());
+    cell_first.assign(cells+1, 0);
+    for(unsigned i=0; i<size(); ++i)
+    {
+        first_column[i] = cellAt(Point<2, X>(boxes[i].xmin(), boxes[i].ymin()));
+        last_column[i] = cellAt(Point<2, X>(boxes[i].xmax(), boxes[i].ymax()));
+        first_row[i] = first_column[i]/index_columns;
+        first_column[i] %= index_columns;
+        last_row[i] = last_column[i]/index_columns;
+        last_column[i] %= index_columns;
+        for(int r=first_row[i]; r<=last_row[i]; ++r)
+            for(int c=first_column[i]; c<=last_column[i]; ++c)
+                ++cell_first[r*index_columns+c+1];
+    }
+    for(int k=0; k<cells; ++k)
+        cell_first[k+1] += cell_first[k];
+    cell_elements.resize(cell_first[cells]);
+    std::vector<unsigned> fill(cell_first.begin(), cell_first.end()-1);
+    for(unsigned i=0; i<size(); ++i)
+        for(int r=first_row[i]; r<=last_row[i]; ++r)
+            for(int c=first_column[i]; c<=last_column[i]; ++c)
+                cell_elements[fill[r*index_columns+c]++] = i;
+};
+
+template<class X>
+inline int SemSolver::Polygonation<2, X>::cellAt(SemSolver::Point<2, X> const &point)
+        const
+{
+    if(!index_built)
+        buildIndex();
+    if(!index_columns)
+        return -1;
+    double x = CGAL::to_double(point.x());
+    double y = CGAL::to_double(point.y());
+    if(x<index_box.xmin() || x>index_box.xmax() ||
+       y<index_box.ymin() || y>index_box.ymax())
+        return -1;
+    double width = index_box.xmax()-index_box.xmin();
+    double height = index_box.ymax()-index_box.ymin();
+    int c = width>0 ? (int)((x-index_box.xmin())/width*index_columns) : 0;
+    int r = height>0 ? (int)((y-index_box.ymin())/height*index_rows) : 0;
+    c = std::min(c, index_columns-1);
+    r = std::min(r, index_rows-1);
+    return r*index_columns+c;
+};
+
+template<class X>
+inline bool SemSolver::Polygonation<2, X>::boxContains(unsigned const &index,
+                                                       SemSolver::Point<2, X> const &point)
+        const
+{
+    double x = CGAL::to_double(point.x());
+    double y = CGAL::to_double(point.y());
+    CGAL::Bbox_2 const &box = boxes[index];
+    return box.xmin()<=x && x<=box.xmax() && box.ymin()<=y && y<=box.ymax();
+};
+
 template<class X>
 inline SemSolver::Polygonation<2, X>::Element::Element()
 {};
@@ -288,7 +1014,7 @@ template<class X>
 unsigned SemSolver::Polygonation<2, X>::Element::vertexPosition(Point<2, X> const &vertex)
         const
 {
-    for(int i=0; i<polygon.size(); ++i)
+    for(unsigned i=0; i<polygon.size(); ++i)
     {
         if(polygon.vertex(i) == vertex)
         {
@@ -0,0 +1,81 @@
+#ifndef POLYGONATIONCACHE_HPP
+#define POLYGONATIONCACHE_HPP
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <SemSolver/polygonation.hpp>
+
+//! \brief Project main namespace
+namespace SemSolver
+{
+    //! \brief Class for keeping recently computed polygonations in memory
+    /*! Polygonations are keyed by a content hash of what they were computed from,
+        see PreProcessor::compute_pslg_hash, and least recently used ones are dropped
+        when the total number of elements exceeds capacity. All methods are thread
+        safe. */
+    template<class X>
+    class PolygonationCache
+    {
+        QCache< QByteArray, Polygonation<2,X> > cache;
+        QMutex                                  mutex;
+
+    public:
+        //! Default capacity, in elements
+        static const int default_capacity = 1 << 22;
+
+        //! Construct an empty cache
+        //! \param capacity Maximum total number of elements
+        PolygonationCache(int const &capacity = default_capacity)
+            : cache(capacity)
+        {
+        };
+
+        //! Get the cache shared by the whole process
+        static PolygonationCache &global()
+        {
+            static PolygonationCache instance;
+            return instance;
+        };
+
+        //! Get a cached Polygonation, marking it as the most recently used one
+        //! \param hash Content hash of the Polygonation
+        //! \param polygonation Polygonation reference where to copy it
+        //! \return false if there is no Polygonation with that hash
+        bool find(QByteArray const &hash, Polygonation<2,X> &polygonation)
+        {
+            QMutexLocker locker(&mutex);
+            Polygonation<2,X> const *cached = cache.object(hash);
+            if(!cached)
+                return false;
+            polygonation = *cached;
+            return true;
+        };
+
+        //! Add a copy of a Polygonation, replacing any one with the same hash
+        /*! Polygonations larger than capacity are not cached */
+        void insert(QByteArray const &hash, Polygonation<2,X> const &polygonation)
+        {
+            QMutexLocker locker(&mutex);
+            cache.insert(hash, new Polygonation<2,X>(polygonation), polygonation.size()+1);
+        };
+
+        //! Drop all cached polygonations
+        void clear()
+        {
+            QMutexLocker locker(&mutex);
+            cache.clear();
+        };
+
+        //! Set maximum total number of elements
+        void setCapacity(int const &capacity)
+        {
+            QMutexLocker locker(&mutex);
+            cache.setMaxCost(capacity);
+        };
+    };
+};
+
+#endif // POLYGONATIONCACHE_HPP
@@ -89,11 +89,11 @@ namespace SemSolver
         //! Compute function value at a point
         double evaluate(Point<2,X> const &x) const
         {
-            std::vector<unsigned> element_index = _polygonation.elementIndicesAt(x);
-            if(element_index.size()==0)
+            int element_index = _polygonation.elementIndexAt(x);
+            if(element_index<0)
                 return 0.;
-            Point<2,X> x_hat = map(element_index[0]).evaluateInverse(x);
-            return polynomial(element_index[0]).evaluate(x_hat);
+            Point<2,X> x_hat = map(element_index).evaluateInverse(x);
+            return polynomial(element_index).evaluate(x_hat);
         };
 
         //! Compute gradient of function restriction on a subdomain element
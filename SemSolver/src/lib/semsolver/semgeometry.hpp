@@ -62,7 +62,7 @@ namespace SemSolver
 //! Check if a point doesn't lie outside the domain
         inline bool contains(const Point<2, X> &point) const
 {
-    return !sub_domains.elementIndicesAt(point).empty();
+    return sub_domains.elementIndexAt(point)>=0;
 };
     };
 };
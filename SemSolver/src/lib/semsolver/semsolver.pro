@@ -14,6 +14,7 @@ HEADERS += vector.hpp \
     polynomialfunction.hpp \
     polynomial.hpp \
     polygonwithholes.hpp \
+    polygonationcache.hpp \
     polygonation.hpp \
     polygon.hpp \
     pointsset.hpp \
@@ -24,6 +25,7 @@ HEADERS += vector.hpp \
     matrix.hpp \
     homeomorphism.hpp \
     hilbertspace.hpp \
+    gausslobattolegendre.hpp \
     function.hpp \
     equation.hpp \
     diffusionconvectionreactionequation.hpp \